@@ -104,7 +104,9 @@ ior_aiori_t hdf5_aiori = {
         HDF5_Delete,
         HDF5_SetVersion,
         HDF5_Fsync,
-        HDF5_GetFileSize
+        HDF5_GetFileSize,
+
+        NULL
 };
 
 static hid_t xferPropList;      /* xfer property list */
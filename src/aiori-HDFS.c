@@ -122,7 +122,9 @@ ior_aiori_t hdfs_aiori = {
 	HDFS_Delete,
 	HDFS_SetVersion,
 	HDFS_Fsync,
-	HDFS_GetFileSize
+	HDFS_GetFileSize,
+
+	NULL
 };
 
 /***************************** F U N C T I O N S ******************************/
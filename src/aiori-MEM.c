@@ -0,0 +1,294 @@
+/* -*- mode: c; c-basic-offset: 8; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=8:tabstop=8:
+ */
+/******************************************************************************\
+*                                                                              *
+*        Copyright (c) 2003, The Regents of the University of California       *
+*      See the file COPYRIGHT for a complete copyright notice and license.     *
+*                                                                              *
+********************************************************************************
+*
+* Implement of abstract I/O interface for memory.
+*
+* A file is a POSIX shared memory object the size of the test's file, mapped
+* once by each task that creates or opens it, so that the tasks of a node see
+* one copy of a shared file and can read back each other's files.  Tasks on
+* other nodes have their own copy.  A transfer is a memcpy, or with memCopy=0
+* nothing at all, leaving only IOR's own cost per operation.
+*
+\******************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ior.h"
+#include "aiori.h"
+#include "iordef.h"
+#include "utilities.h"
+
+typedef struct mem_file {
+        char name[MAX_STR];             /* test file name */
+        char *base;                     /* mapping of the file */
+        IOR_offset_t size;
+        int created;                    /* by this task, which removes it */
+        struct mem_file *next;
+} mem_file_t;
+
+/**************************** P R O T O T Y P E S *****************************/
+static void *MEM_Create(char *, IOR_param_t *);
+static void *MEM_Open(char *, IOR_param_t *);
+static IOR_offset_t MEM_Xfer(int, void *, IOR_size_t *,
+                             IOR_offset_t, IOR_param_t *);
+static void MEM_Close(void *, IOR_param_t *);
+static void MEM_Delete(char *, IOR_param_t *);
+static void MEM_SetVersion(IOR_param_t *);
+static void MEM_Fsync(void *, IOR_param_t *);
+static IOR_offset_t MEM_GetFileSize(IOR_param_t *, MPI_Comm, char *);
+
+/************************** D E C L A R A T I O N S ***************************/
+
+ior_aiori_t mem_aiori = {
+        "MEM",
+        MEM_Create,
+        MEM_Open,
+        MEM_Xfer,
+        MEM_Close,
+        MEM_Delete,
+        MEM_SetVersion,
+        MEM_Fsync,
+        MEM_GetFileSize,
+
+        NULL
+};
+
+static mem_file_t *files;               /* files this task has mapped */
+static IOR_offset_t ops;                /* transfers since the reset */
+
+/***************************** F U N C T I O N S ******************************/
+
+/*
+ * Name of the shared memory object holding a test file.
+ */
+static void ShmName(char *shmName, char *testFileName)
+{
+        unsigned long long h = 0xcbf29ce484222325ULL;   /* FNV-1a */
+        char *p;
+
+        for (p = testFileName; *p != '\0'; p++)
+                h = (h ^ (unsigned char)*p) * 0x100000001b3ULL;
+        sprintf(shmName, "/ior-mem-%d-%016llx", (int)getuid(), h);
+}
+
+/*
+ * Bytes in one test file: a task's blocks, or those of all tasks sharing it.
+ */
+static IOR_offset_t FileSize(IOR_param_t * param)
+{
+        IOR_offset_t tasks = 1;
+
+        if (!param->filePerProc)
+                tasks = param->tasksPerFile ? param->tasksPerFile
+                                            : param->numTasks
+                                              * param->virtualRanks;
+        return (param->blockSize * param->segmentCount * tasks);
+}
+
+static mem_file_t *FileFind(char *testFileName)
+{
+        mem_file_t *f;
+
+        for (f = files; f != NULL; f = f->next)
+                if (strcmp(f->name, testFileName) == 0)
+                        return (f);
+        return (NULL);
+}
+
+static void FileUnmap(char *testFileName)
+{
+        mem_file_t **f, *old;
+
+        for (f = &files; *f != NULL; f = &(*f)->next) {
+                if (strcmp((*f)->name, testFileName) == 0) {
+                        old = *f;
+                        *f = old->next;
+                        if (munmap(old->base, old->size) != 0)
+                                ERR("munmap() failed");
+                        free(old);
+                        return;
+                }
+        }
+}
+
+/*
+ * Map a test file, creating its memory object if asked.  A task creating a
+ * shared file leaves what other tasks have written in place.
+ */
+static mem_file_t *FileMap(char *testFileName, IOR_param_t * param,
+                           int create)
+{
+        char shmName[MAX_STR];
+        struct stat st;
+        mem_file_t *f;
+        int fd, flags = O_RDWR;
+        IOR_offset_t size = FileSize(param);
+
+        ShmName(shmName, testFileName);
+        if (create)
+                flags |= O_CREAT | (param->filePerProc ? O_TRUNC : 0);
+        fd = shm_open(shmName, flags, 0600);
+        if (fd < 0) {
+                if (errno == ENOENT)
+                        ERR("memory file not found, it may have been written on another node");
+                ERR("shm_open() failed");
+        }
+        if (fstat(fd, &st) != 0)
+                ERR("fstat() failed");
+        if (st.st_size < size) {
+                if (ftruncate(fd, size) != 0)
+                        ERR("ftruncate() failed");
+        } else {
+                size = st.st_size;
+        }
+
+        f = (mem_file_t *)malloc(sizeof(mem_file_t));
+        if (f == NULL)
+                ERR("malloc failed");
+        strcpy(f->name, testFileName);
+        f->size = size;
+        f->created = create;
+        f->base = (char *)mmap(NULL, size, PROT_READ | PROT_WRITE,
+                               MAP_SHARED, fd, 0);
+        if (f->base == MAP_FAILED)
+                ERR("mmap() failed");
+        close(fd);
+        f->next = files;
+        files = f;
+        return (f);
+}
+
+/*
+ * Return the transfers made since the count was reset.
+ */
+IOR_offset_t MEM_Ops(void)
+{
+        return (ops);
+}
+
+void MEM_OpsReset(void)
+{
+        ops = 0;
+}
+
+/*
+ * Create a file; any earlier mapping of the name is dropped, as the object
+ * may have been removed and created anew since.
+ */
+static void *MEM_Create(char *testFileName, IOR_param_t * param)
+{
+        FileUnmap(testFileName);
+        return (FileMap(testFileName, param, TRUE));
+}
+
+static void *MEM_Open(char *testFileName, IOR_param_t * param)
+{
+        mem_file_t *f = FileFind(testFileName);
+
+        if (f != NULL)
+                return (f);
+        return (FileMap(testFileName, param, FALSE));
+}
+
+static IOR_offset_t MEM_Xfer(int access, void *file, IOR_size_t * buffer,
+                             IOR_offset_t length, IOR_param_t * param)
+{
+        mem_file_t *f = (mem_file_t *)file;
+
+        if (param->offset < 0 || param->offset + length > f->size)
+                ERR("transfer beyond the end of the memory file");
+        ops++;
+        if (!param->memCopy)
+                return (length);
+        if (access == WRITE)
+                memcpy(f->base + param->offset, buffer, length);
+        else
+                memcpy(buffer, f->base + param->offset, length);
+        return (length);
+}
+
+/*
+ * A task keeps the mapping of a file it created until it removes the file,
+ * so reopening it is free.  Another task's file may be removed and created
+ * anew without this task knowing, so its mapping is dropped.
+ */
+static void MEM_Close(void *file, IOR_param_t * param)
+{
+        mem_file_t *f = (mem_file_t *)file;
+
+        if (!f->created)
+                FileUnmap(f->name);
+}
+
+/*
+ * Remove a file.  Its memory is freed once the last task of the node has
+ * unmapped it.
+ */
+static void MEM_Delete(char *testFileName, IOR_param_t * param)
+{
+        char shmName[MAX_STR];
+
+        FileUnmap(testFileName);
+        ShmName(shmName, testFileName);
+        if (shm_unlink(shmName) != 0 && errno != ENOENT)
+                EWARN("shm_unlink() failed");
+}
+
+static void MEM_SetVersion(IOR_param_t * param)
+{
+        snprintf(param->apiVersion, MAX_STR, "%s (%s)", mem_aiori.name,
+                param->memCopy ? "memcpy" : "no copy");
+}
+
+static void MEM_Fsync(void *file, IOR_param_t * param)
+{
+}
+
+/*
+ * Return the aggregate size of the files, as the POSIX backend does.
+ */
+static IOR_offset_t MEM_GetFileSize(IOR_param_t * param, MPI_Comm testComm,
+                                    char *testFileName)
+{
+        mem_file_t *f = FileFind(testFileName);
+        IOR_offset_t size, min, max;
+
+        if (f != NULL) {
+                size = f->size;
+        } else {
+                f = FileMap(testFileName, param, FALSE);
+                size = f->size;
+                FileUnmap(testFileName);
+        }
+        if (param->filePerProc) {
+                MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &size, 1,
+                                        MPI_LONG_LONG_INT, MPI_SUM, testComm),
+                          "cannot total file sizes");
+                return (size);
+        }
+        MPI_CHECK(MPI_Allreduce(&size, &min, 1, MPI_LONG_LONG_INT, MPI_MIN,
+                                testComm), "cannot total file sizes");
+        MPI_CHECK(MPI_Allreduce(&size, &max, 1, MPI_LONG_LONG_INT, MPI_MAX,
+                                testComm), "cannot total file sizes");
+        if (min != max && rank == 0)
+                WARN("inconsistent file size by different tasks");
+        return (min);
+}
@@ -18,6 +18,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 
 #include "ior.h"
@@ -29,6 +30,14 @@
 #define MPIAPI                  /* defined as __stdcall on Windows */
 #endif
 
+#if MPI_VERSION >= 3
+#define MPIIO_CONST const       /* MPI-3 write buffers are const */
+#else
+#define MPIIO_CONST
+#endif
+
+#define SHARED_POINTER_PROBES 16        /* zero-byte calls to time */
+
 /**************************** P R O T O T Y P E S *****************************/
 
 static IOR_offset_t SeekOffset(MPI_File, IOR_offset_t, IOR_param_t *);
@@ -41,9 +50,26 @@ static void MPIIO_Close(void *, IOR_param_t *);
 static void MPIIO_Delete(char *, IOR_param_t *);
 static void MPIIO_SetVersion(IOR_param_t *);
 static void MPIIO_Fsync(void *, IOR_param_t *);
+static IOR_offset_t MPIIO_XferNonblocking(int, void *, IOR_size_t *,
+                                          IOR_offset_t, IOR_param_t *);
 
 /************************** D E C L A R A T I O N S ***************************/
 
+/* window of outstanding nonblocking requests, one buffer per slot */
+static struct {
+        MPI_Request *request;
+        void **buffer;
+        IOR_offset_t *length;
+        int slots;
+        IOR_offset_t bufferSize;
+} window = { NULL, NULL, NULL, 0, 0 };
+
+/* shared-file-pointer transfers of the current phase */
+static struct {
+        IOR_offset_t calls;
+        double time;
+} sharedPointer = { 0, 0.0 };
+
 ior_aiori_t mpiio_aiori = {
         "MPIIO",
         MPIIO_Create,
@@ -53,7 +79,9 @@ ior_aiori_t mpiio_aiori = {
         MPIIO_Delete,
         MPIIO_SetVersion,
         MPIIO_Fsync,
-        MPIIO_GetFileSize
+        MPIIO_GetFileSize,
+
+        NULL
 };
 
 /***************************** F U N C T I O N S ******************************/
@@ -87,6 +115,8 @@ static void *MPIIO_Open(char *testFileName, IOR_param_t * param)
                 ERR("malloc failed()");
 
         *fd = 0;
+        sharedPointer.calls = 0;
+        sharedPointer.time = 0.0;
 
         /* set IOR file flags to MPIIO flags */
         /* -- file open flags -- */
@@ -125,7 +155,7 @@ static void *MPIIO_Open(char *testFileName, IOR_param_t * param)
         if (param->filePerProc) {
                 comm = MPI_COMM_SELF;
         } else {
-                comm = testComm;
+                comm = fileComm;
         }
 
         SetHints(&mpiHints, param->hintsFileName);
@@ -161,7 +191,9 @@ static void *MPIIO_Open(char *testFileName, IOR_param_t * param)
                                                (MPI_Offset) (param->segmentCount
                                                              *
                                                              param->blockSize *
-                                                             param->numTasks)),
+                                                             (param->tasksPerFile ?
+                                                              param->tasksPerFile :
+                                                              param->numTasks))),
                           "cannot preallocate file");
         }
         /* create file view */
@@ -177,8 +209,45 @@ static void *MPIIO_Open(char *testFileName, IOR_param_t * param)
                         offsetFactor = 0;
                         tasksPerFile = 1;
                 } else {
-                        offsetFactor = (rank + rankOffset) % param->numTasks;
-                        tasksPerFile = param->numTasks;
+                        tasksPerFile = param->tasksPerFile ?
+                                param->tasksPerFile : param->numTasks;
+                        offsetFactor = ((rank + rankOffset) % param->numTasks)
+                                       % tasksPerFile;
+                }
+
+                if (param->subarrayDims > 0) {
+                        /* each task's view is its subarray of the global array */
+                        MPI_Datatype elementType;
+                        int localSizes[3], startIndices[3], d;
+
+                        SubarrayStart(param, (rank + rankOffset) % param->numTasks,
+                                      startIndices);
+                        for (d = 0; d < param->subarrayDims; d++)
+                                localSizes[d] = param->globalDims[d]
+                                                / param->processGrid[d];
+                        MPI_CHECK(MPI_Type_contiguous(param->elementSize, MPI_BYTE,
+                                                      &elementType),
+                                  "cannot create element datatype");
+                        MPI_CHECK(MPI_Type_commit(&elementType),
+                                  "cannot commit datatype");
+                        MPI_CHECK(MPI_Type_create_subarray
+                                  (param->subarrayDims, param->globalDims,
+                                   localSizes, startIndices, MPI_ORDER_C,
+                                   elementType, &param->fileType),
+                                  "cannot create subarray");
+                        MPI_CHECK(MPI_Type_commit(&param->fileType),
+                                  "cannot commit datatype");
+                        MPI_CHECK(MPI_File_set_view(*fd, (MPI_Offset) 0,
+                                                    elementType,
+                                                    param->fileType, "native",
+                                                    (MPI_Info) MPI_INFO_NULL),
+                                  "cannot set file view");
+                        MPI_CHECK(MPI_Type_free(&elementType),
+                                  "cannot free MPI element datatype");
+                        if (mpiHints != MPI_INFO_NULL)
+                                MPI_CHECK(MPI_Info_free(&mpiHints),
+                                          "MPI_Info_free failed");
+                        return ((void *)fd);
                 }
 
                 /*
@@ -220,9 +289,7 @@ static IOR_offset_t MPIIO_Xfer(int access, void *fd, IOR_size_t * buffer,
                                IOR_offset_t length, IOR_param_t * param)
 {
         /* NOTE: The second arg is (void *) for reads, and (const void *)
-           for writes.  Therefore, one of the two sets of assignments below
-           will get "assignment from incompatible pointer-type" warnings,
-           if we only use this one set of signatures. */
+           for writes, so each has its own set of function pointers. */
 
         int (MPIAPI * Access) (MPI_File, void *, int,
                                MPI_Datatype, MPI_Status *);
@@ -232,36 +299,44 @@ static IOR_offset_t MPIIO_Xfer(int access, void *fd, IOR_size_t * buffer,
                                    MPI_Datatype, MPI_Status *);
         int (MPIAPI * Access_at_all) (MPI_File, MPI_Offset, void *, int,
                                       MPI_Datatype, MPI_Status *);
-        /*
-         * this needs to be properly implemented:
-         *
-         *   int        (*Access_ordered)(MPI_File, void *, int,
-         *                                MPI_Datatype, MPI_Status *);
-         */
+        int (MPIAPI * Access_ordered) (MPI_File, void *, int,
+                                       MPI_Datatype, MPI_Status *);
+        int (MPIAPI * Access_shared) (MPI_File, void *, int,
+                                      MPI_Datatype, MPI_Status *);
+        int (MPIAPI * Write) (MPI_File, MPIIO_CONST void *, int,
+                              MPI_Datatype, MPI_Status *);
+        int (MPIAPI * Write_at) (MPI_File, MPI_Offset, MPIIO_CONST void *, int,
+                                 MPI_Datatype, MPI_Status *);
+        int (MPIAPI * Write_all) (MPI_File, MPIIO_CONST void *, int,
+                                  MPI_Datatype, MPI_Status *);
+        int (MPIAPI * Write_at_all) (MPI_File, MPI_Offset, MPIIO_CONST void *,
+                                     int, MPI_Datatype, MPI_Status *);
+        int (MPIAPI * Write_ordered) (MPI_File, MPIIO_CONST void *, int,
+                                      MPI_Datatype, MPI_Status *);
+        int (MPIAPI * Write_shared) (MPI_File, MPIIO_CONST void *, int,
+                                     MPI_Datatype, MPI_Status *);
         MPI_Status status;
-
-        /* point functions to appropriate MPIIO calls */
-        if (access == WRITE) {  /* WRITE */
-                Access = MPI_File_write;
-                Access_at = MPI_File_write_at;
-                Access_all = MPI_File_write_all;
-                Access_at_all = MPI_File_write_at_all;
-                /*
-                 * this needs to be properly implemented:
-                 *
-                 *   Access_ordered = MPI_File_write_ordered;
-                 */
-        } else {                /* READ or CHECK */
-                Access = MPI_File_read;
-                Access_at = MPI_File_read_at;
-                Access_all = MPI_File_read_all;
-                Access_at_all = MPI_File_read_at_all;
-                /*
-                 * this needs to be properly implemented:
-                 *
-                 *   Access_ordered = MPI_File_read_ordered;
-                 */
-        }
+        double start;
+
+        /* timed transfers may be left in flight; checks stay blocking */
+        if (param->nonblockingWindow > 0 && (access == WRITE || access == READ))
+                return (MPIIO_XferNonblocking(access, fd, buffer, length,
+                                              param));
+
+        /* point functions to appropriate MPIIO calls; WRITE uses the
+           Write set, READ and CHECK the Access set */
+        Write = MPI_File_write;
+        Write_at = MPI_File_write_at;
+        Write_all = MPI_File_write_all;
+        Write_at_all = MPI_File_write_at_all;
+        Write_ordered = MPI_File_write_ordered;
+        Write_shared = MPI_File_write_shared;
+        Access = MPI_File_read;
+        Access_at = MPI_File_read_at;
+        Access_all = MPI_File_read_all;
+        Access_at_all = MPI_File_read_at_all;
+        Access_ordered = MPI_File_read_ordered;
+        Access_shared = MPI_File_read_shared;
 
         /*
          * 'useFileView' uses derived datatypes and individual file pointers
@@ -275,23 +350,33 @@ static IOR_offset_t MPIIO_Xfer(int access, void *fd, IOR_size_t * buffer,
                 } else {
                         /*
                          * 'useStridedDatatype' fits multi-strided pattern into a datatype;
-                         * must use 'length' to determine repetitions (fix this for
-                         * multi-segments someday, WEL):
+                         * 'length' then covers every transfer of every segment,
+                         * which the file view spreads over the segments:
                          * e.g.,  'IOR -s 2 -b 32K -t 32K -a MPIIO -S'
                          */
                         if (param->useStridedDatatype) {
-                                length = param->segmentCount;
+                                length = length / param->transferSize;
                         } else {
                                 length = 1;
                         }
-                        if (param->collective) {
+                        if (param->collective && access == WRITE) {
                                 /* individual, collective call */
+                                MPI_CHECK(Write_all
+                                          (*(MPI_File *) fd, buffer, length,
+                                           param->transferType, &status),
+                                          "cannot access collective");
+                        } else if (param->collective) {
                                 MPI_CHECK(Access_all
                                           (*(MPI_File *) fd, buffer, length,
                                            param->transferType, &status),
                                           "cannot access collective");
-                        } else {
+                        } else if (access == WRITE) {
                                 /* individual, noncollective call */
+                                MPI_CHECK(Write
+                                          (*(MPI_File *) fd, buffer, length,
+                                           param->transferType, &status),
+                                          "cannot access noncollective");
+                        } else {
                                 MPI_CHECK(Access
                                           (*(MPI_File *) fd, buffer, length,
                                            param->transferType, &status),
@@ -302,35 +387,56 @@ static IOR_offset_t MPIIO_Xfer(int access, void *fd, IOR_size_t * buffer,
         } else {
                 /*
                  * !useFileView does not use derived datatypes, but it uses either
-                 * shared or explicit file pointers
+                 * shared or explicit file pointers; checks of a shared-pointer
+                 * test read back through explicit offsets
                  */
-                if (param->useSharedFilePointer) {
-                        /* find offset in file */
-                        if (SeekOffset
-                            (*(MPI_File *) fd, param->offset, param) < 0) {
-                                /* if unsuccessful */
-                                length = -1;
+                if (param->useSharedFilePointer
+                    && (access == WRITE || access == READ)) {
+                        start = MPI_Wtime();
+                        if (param->collective && access == WRITE) {
+                                /* shared, collective call in rank order */
+                                MPI_CHECK(Write_ordered
+                                          (*(MPI_File *) fd, buffer, length,
+                                           MPI_BYTE, &status),
+                                          "cannot access shared, collective");
+                        } else if (param->collective) {
+                                MPI_CHECK(Access_ordered
+                                          (*(MPI_File *) fd, buffer, length,
+                                           MPI_BYTE, &status),
+                                          "cannot access shared, collective");
+                        } else if (access == WRITE) {
+                                /* shared, noncollective call */
+                                MPI_CHECK(Write_shared
+                                          (*(MPI_File *) fd, buffer, length,
+                                           MPI_BYTE, &status),
+                                          "cannot access shared, noncollective");
                         } else {
-                                /* shared, collective call */
-                                /*
-                                 * this needs to be properly implemented:
-                                 *
-                                 *   MPI_CHECK(Access_ordered(fd.MPIIO, buffer, length,
-                                 *                            MPI_BYTE, &status),
-                                 *             "cannot access shared, collective");
-                                 */
-                                fprintf(stdout,
-                                        "useSharedFilePointer not implemented\n");
+                                MPI_CHECK(Access_shared
+                                          (*(MPI_File *) fd, buffer, length,
+                                           MPI_BYTE, &status),
+                                          "cannot access shared, noncollective");
                         }
+                        sharedPointer.time += MPI_Wtime() - start;
+                        sharedPointer.calls++;
                 } else {
-                        if (param->collective) {
+                        if (param->collective && access == WRITE) {
                                 /* explicit, collective call */
+                                MPI_CHECK(Write_at_all
+                                          (*(MPI_File *) fd, param->offset,
+                                           buffer, length, MPI_BYTE, &status),
+                                          "cannot access explicit, collective");
+                        } else if (param->collective) {
                                 MPI_CHECK(Access_at_all
                                           (*(MPI_File *) fd, param->offset,
                                            buffer, length, MPI_BYTE, &status),
                                           "cannot access explicit, collective");
-                        } else {
+                        } else if (access == WRITE) {
                                 /* explicit, noncollective call */
+                                MPI_CHECK(Write_at
+                                          (*(MPI_File *) fd, param->offset,
+                                           buffer, length, MPI_BYTE, &status),
+                                          "cannot access explicit, noncollective");
+                        } else {
                                 MPI_CHECK(Access_at
                                           (*(MPI_File *) fd, param->offset,
                                            buffer, length, MPI_BYTE, &status),
@@ -341,12 +447,261 @@ static IOR_offset_t MPIIO_Xfer(int access, void *fd, IOR_size_t * buffer,
         return (length);
 }
 
+/*
+ * Check the transfers of completed requests and release their slots.
+ */
+static void WindowComplete(int count, int *indices, MPI_Status * statuses)
+{
+        int i, bytes;
+
+        for (i = 0; i < count; i++) {
+                MPI_CHECK(MPI_Get_count(&statuses[i], MPI_BYTE, &bytes),
+                          "cannot get count of nonblocking transfer");
+                if (bytes != window.length[indices[i]])
+                        ERR("nonblocking transfer incomplete");
+                window.length[indices[i]] = 0;
+        }
+}
+
+/*
+ * Return a free slot in the request window, waiting for outstanding
+ * requests to complete when all slots are in use.  The window is
+ * (re)allocated when the window or transfer size changes.
+ */
+static int WindowSlot(IOR_param_t * param)
+{
+        int i, count;
+        int *indices;
+        MPI_Status *statuses;
+
+        if (window.slots != param->nonblockingWindow
+            || window.bufferSize != param->transferSize) {
+                MPIIO_Wait(param);
+                for (i = 0; i < window.slots; i++)
+                        free(window.buffer[i]);
+                free(window.request);
+                free(window.buffer);
+                free(window.length);
+                window.slots = param->nonblockingWindow;
+                window.bufferSize = param->transferSize;
+                window.request = (MPI_Request *)malloc(window.slots
+                                                       * sizeof(MPI_Request));
+                window.buffer = (void **)malloc(window.slots
+                                                * sizeof(void *));
+                window.length = (IOR_offset_t *)malloc(window.slots
+                                                       * sizeof(IOR_offset_t));
+                if (window.request == NULL || window.buffer == NULL
+                    || window.length == NULL)
+                        ERR("out of memory");
+                for (i = 0; i < window.slots; i++) {
+                        window.request[i] = MPI_REQUEST_NULL;
+                        window.length[i] = 0;
+                        window.buffer[i] = malloc(window.bufferSize);
+                        if (window.buffer[i] == NULL)
+                                ERR("out of memory");
+                }
+        }
+
+        for (i = 0; i < window.slots; i++)
+                if (window.request[i] == MPI_REQUEST_NULL)
+                        return (i);
+
+        indices = (int *)malloc(window.slots * sizeof(int));
+        statuses = (MPI_Status *)malloc(window.slots * sizeof(MPI_Status));
+        if (indices == NULL || statuses == NULL)
+                ERR("out of memory");
+        MPI_CHECK(MPI_Waitsome(window.slots, window.request, &count,
+                               indices, statuses),
+                  "cannot wait for nonblocking transfers");
+        WindowComplete(count, indices, statuses);
+        i = indices[0];
+        free(indices);
+        free(statuses);
+        return (i);
+}
+
+/*
+ * Start a transfer with MPI_File_iwrite_at[_all]()/iread_at[_all]() and
+ * leave it in flight in the request window.  Reads land in the slot's
+ * buffer.  Writes are sent from the caller's buffer, which is unchanged
+ * between transfers unless offsets are stored in it; then the slot keeps
+ * a copy.
+ */
+static IOR_offset_t MPIIO_XferNonblocking(int access, void *fd,
+                                          IOR_size_t * buffer,
+                                          IOR_offset_t length,
+                                          IOR_param_t * param)
+{
+        int slot = WindowSlot(param);
+        void *data = window.buffer[slot];
+
+        if (access == WRITE) {
+                if (param->storeFileOffset)
+                        memcpy(data, buffer, length);
+                else
+                        data = buffer;
+                if (param->collective) {
+                        MPI_CHECK(MPI_File_iwrite_at_all
+                                  (*(MPI_File *) fd, param->offset, data,
+                                   length, MPI_BYTE, &window.request[slot]),
+                                  "cannot start explicit, collective write");
+                } else {
+                        MPI_CHECK(MPI_File_iwrite_at
+                                  (*(MPI_File *) fd, param->offset, data,
+                                   length, MPI_BYTE, &window.request[slot]),
+                                  "cannot start explicit, noncollective write");
+                }
+        } else {
+                if (param->collective) {
+                        MPI_CHECK(MPI_File_iread_at_all
+                                  (*(MPI_File *) fd, param->offset, data,
+                                   length, MPI_BYTE, &window.request[slot]),
+                                  "cannot start explicit, collective read");
+                } else {
+                        MPI_CHECK(MPI_File_iread_at
+                                  (*(MPI_File *) fd, param->offset, data,
+                                   length, MPI_BYTE, &window.request[slot]),
+                                  "cannot start explicit, noncollective read");
+                }
+        }
+        window.length[slot] = length;
+        return (length);
+}
+
+/*
+ * Wait for all transfers in the request window to complete.
+ */
+void MPIIO_Wait(IOR_param_t * param)
+{
+        int i, count = 0;
+        int *indices;
+        MPI_Status *statuses;
+
+        if (window.slots == 0)
+                return;
+        indices = (int *)malloc(window.slots * sizeof(int));
+        statuses = (MPI_Status *)malloc(window.slots * sizeof(MPI_Status));
+        if (indices == NULL || statuses == NULL)
+                ERR("out of memory");
+        for (i = 0; i < window.slots; i++) {
+                if (window.request[i] == MPI_REQUEST_NULL)
+                        continue;
+                MPI_CHECK(MPI_Wait(&window.request[i], &statuses[count]),
+                          "cannot wait for nonblocking transfers");
+                indices[count++] = i;
+        }
+        WindowComplete(count, indices, statuses);
+        free(indices);
+        free(statuses);
+}
+
+/*
+ * Access 'count' transfers at the sorted 'offsets' with one collective call,
+ * through a file view of just those transfers; a task with no transfers in
+ * the round still joins it.  The view is left in place, since each batch
+ * sets its own and the file is closed after the phase.
+ */
+IOR_offset_t MPIIO_XferBatch(int access, void *fd, IOR_size_t * buffer,
+                             IOR_offset_t * offsets, int count,
+                             IOR_param_t * param)
+{
+        MPI_Datatype fileType = MPI_BYTE;
+        MPI_Aint *displacements;
+        MPI_Status status;
+        int i, length = count * param->transferSize;
+
+        if (count > 0) {
+                displacements = (MPI_Aint *)malloc(count * sizeof(MPI_Aint));
+                if (displacements == NULL)
+                        ERR("out of memory");
+                for (i = 0; i < count; i++)
+                        displacements[i] = (MPI_Aint)offsets[i];
+                MPI_CHECK(MPI_Type_create_hindexed_block
+                          (count, param->transferSize, displacements,
+                           MPI_BYTE, &fileType),
+                          "cannot create hindexed datatype");
+                MPI_CHECK(MPI_Type_commit(&fileType),
+                          "cannot commit datatype");
+                free(displacements);
+        }
+        MPI_CHECK(MPI_File_set_view(*(MPI_File *) fd, (MPI_Offset) 0,
+                                    MPI_BYTE, fileType, "native",
+                                    (MPI_Info) MPI_INFO_NULL),
+                  "cannot set file view");
+        if (access == WRITE) {
+                MPI_CHECK(MPI_File_write_at_all(*(MPI_File *) fd, 0, buffer,
+                                                length, MPI_BYTE, &status),
+                          "cannot access batch, collective");
+        } else {
+                MPI_CHECK(MPI_File_read_at_all(*(MPI_File *) fd, 0, buffer,
+                                               length, MPI_BYTE, &status),
+                          "cannot access batch, collective");
+        }
+        if (count > 0)
+                MPI_CHECK(MPI_Type_free(&fileType),
+                          "cannot free MPI file datatype");
+
+        return ((IOR_offset_t)length);
+}
+
+/*
+ * Estimate the cost of maintaining the shared file pointer by reopening the
+ * file and timing zero-byte shared-pointer calls, which update the pointer
+ * but move no data.  Returns the mean seconds per call, and the number of
+ * and time spent in the shared-pointer transfers of the last phase.
+ */
+double MPIIO_SharedPointerCost(IOR_param_t * test, char *testFileName,
+                               int access, IOR_offset_t * calls,
+                               double *callTime)
+{
+        MPI_File fd;
+        MPI_Info mpiHints = MPI_INFO_NULL;
+        MPI_Status status;
+        char byte;
+        double start, probeTime;
+        int i;
+
+        *calls = sharedPointer.calls;
+        *callTime = sharedPointer.time;
+
+        SetHints(&mpiHints, test->hintsFileName);
+        MPI_CHECK(MPI_File_open(test->filePerProc ? MPI_COMM_SELF : fileComm,
+                                testFileName, MPI_MODE_RDWR, mpiHints, &fd),
+                  "cannot open file to probe shared file pointer");
+        if (mpiHints != MPI_INFO_NULL)
+                MPI_CHECK(MPI_Info_free(&mpiHints), "MPI_Info_free failed");
+        start = MPI_Wtime();
+        for (i = 0; i < SHARED_POINTER_PROBES; i++) {
+                if (test->collective && access == WRITE) {
+                        MPI_CHECK(MPI_File_write_ordered(fd, &byte, 0,
+                                                         MPI_BYTE, &status),
+                                  "cannot probe shared, collective");
+                } else if (test->collective) {
+                        MPI_CHECK(MPI_File_read_ordered(fd, &byte, 0,
+                                                        MPI_BYTE, &status),
+                                  "cannot probe shared, collective");
+                } else if (access == WRITE) {
+                        MPI_CHECK(MPI_File_write_shared(fd, &byte, 0,
+                                                        MPI_BYTE, &status),
+                                  "cannot probe shared, noncollective");
+                } else {
+                        MPI_CHECK(MPI_File_read_shared(fd, &byte, 0,
+                                                       MPI_BYTE, &status),
+                                  "cannot probe shared, noncollective");
+                }
+        }
+        probeTime = (MPI_Wtime() - start) / SHARED_POINTER_PROBES;
+        MPI_CHECK(MPI_File_close(&fd), "cannot close file");
+
+        return (probeTime);
+}
+
 /*
  * Perform fsync().
  */
 static void MPIIO_Fsync(void *fd, IOR_param_t * param)
 {
-        ;
+        MPIIO_Wait(param);
 }
 
 /*
@@ -354,6 +709,7 @@ static void MPIIO_Fsync(void *fd, IOR_param_t * param)
  */
 static void MPIIO_Close(void *fd, IOR_param_t * param)
 {
+        MPIIO_Wait(param);
         MPI_CHECK(MPI_File_close((MPI_File *) fd), "cannot close file");
         if ((param->useFileView == TRUE) && (param->fd_fppReadCheck == NULL)) {
                 /*
@@ -403,14 +759,21 @@ static IOR_offset_t SeekOffset(MPI_File fd, IOR_offset_t offset,
                 offsetFactor = 0;
                 tasksPerFile = 1;
         } else {
-                offsetFactor = (rank + rankOffset) % param->numTasks;
-                tasksPerFile = param->numTasks;
+                tasksPerFile = param->tasksPerFile ?
+                        param->tasksPerFile : param->numTasks;
+                offsetFactor = ((rank + rankOffset) % param->numTasks)
+                               % tasksPerFile;
         }
         if (param->useFileView) {
                 /* recall that offsets in a file view are
                    counted in units of transfer size */
                 if (param->filePerProc) {
                         tempOffset = tempOffset / param->transferSize;
+                } else if (param->subarrayDims > 0) {
+                        /* views of subarrays are counted in elements */
+                        tempOffset = (tempOffset / (param->blockSize
+                                                    * param->numTasks))
+                                     * (param->blockSize / param->elementSize);
                 } else {
                         /* 
                          * this formula finds a file view offset for a task
@@ -68,7 +68,9 @@ ior_aiori_t ncmpi_aiori = {
         NCMPI_Delete,
         NCMPI_SetVersion,
         NCMPI_Fsync,
-        NCMPI_GetFileSize
+        NCMPI_GetFileSize,
+
+        NULL
 };
 
 /***************************** F U N C T I O N S ******************************/
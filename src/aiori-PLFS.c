@@ -115,7 +115,9 @@ ior_aiori_t plfs_aiori = {
         PLFS_Delete,
         PLFS_SetVersion,
         PLFS_Fsync,
-        PLFS_GetFileSize
+        PLFS_GetFileSize,
+
+        NULL
 };
 
 /***************************** F U N C T I O N S ******************************/
@@ -80,7 +80,9 @@ ior_aiori_t posix_aiori = {
         POSIX_Delete,
         POSIX_SetVersion,
         POSIX_Fsync,
-        POSIX_GetFileSize
+        POSIX_GetFileSize,
+
+        NULL
 };
 
 /***************************** F U N C T I O N S ******************************/
@@ -178,8 +180,12 @@ static void *POSIX_Create(char *testFileName, IOR_param_t * param)
                 /* In the single-shared-file case, task 0 has to creat the
                    file with the Lustre striping options before any other processes
                    open the file */
-                if (!param->filePerProc && rank != 0) {
-                        MPI_CHECK(MPI_Barrier(testComm), "barrier error");
+                int fileRank;
+
+                MPI_CHECK(MPI_Comm_rank(fileComm, &fileRank),
+                          "cannot get rank");
+                if (!param->filePerProc && fileRank != 0) {
+                        MPI_CHECK(MPI_Barrier(fileComm), "barrier error");
                         fd_oflag |= O_RDWR;
                         *fd = open64(testFileName, fd_oflag, 0664);
                         if (*fd < 0)
@@ -214,7 +220,7 @@ static void *POSIX_Create(char *testFileName, IOR_param_t * param)
                                           "MPI_Abort() error");
                         }
                         if (!param->filePerProc)
-                                MPI_CHECK(MPI_Barrier(testComm),
+                                MPI_CHECK(MPI_Barrier(fileComm),
                                           "barrier error");
                 }
         } else {
@@ -140,7 +140,9 @@ ior_aiori_t s3_aiori = {
 	S3_Delete,
 	S3_SetVersion,
 	S3_Fsync,
-	S3_GetFileSize
+	S3_GetFileSize,
+
+	NULL
 };
 
 // "S3", plus EMC-extensions enabled
@@ -155,7 +157,9 @@ ior_aiori_t s3_plus_aiori = {
 	S3_Delete,
 	S3_SetVersion,
 	S3_Fsync,
-	S3_GetFileSize
+	S3_GetFileSize,
+
+	NULL
 };
 
 // Use EMC-extensions for N:1 write, as well
@@ -170,7 +174,9 @@ ior_aiori_t s3_emc_aiori = {
 	S3_Delete,
 	S3_SetVersion,
 	S3_Fsync,
-	S3_GetFileSize
+	S3_GetFileSize,
+
+	NULL
 };
 
 
@@ -0,0 +1,456 @@
+/* -*- mode: c; c-basic-offset: 8; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=8:tabstop=8:
+ */
+/******************************************************************************\
+*                                                                              *
+*        Copyright (c) 2003, The Regents of the University of California       *
+*      See the file COPYRIGHT for a complete copyright notice and license.     *
+*                                                                              *
+********************************************************************************
+*
+* Compression stage of the abstract I/O interface.  Stacked on a backend, it
+* compresses each transfer before the backend writes it and decompresses it
+* after reading.
+*
+* A transfer is stored at its own offset as a record: a header giving the
+* codec and the compressed length, then the compressed bytes.  The rest of
+* the transfer's extent is left unwritten.  A transfer that does not shrink is
+* stored as is.  Each task keeps an index of the extents it stored, so that it
+* reads back only the stored bytes; extents it does not know are found by
+* reading the header first.
+*
+\******************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>               /* clock_gettime() */
+
+#if defined(HAVE_ZLIB_H) && defined(HAVE_LIBZ)
+#  include <zlib.h>
+#endif
+#if defined(HAVE_LZ4_H) && defined(HAVE_LIBLZ4)
+#  include <lz4.h>
+#endif
+#if defined(HAVE_ZSTD_H) && defined(HAVE_LIBZSTD)
+#  include <zstd.h>
+#endif
+
+#include "ior.h"
+#include "aiori.h"
+#include "iordef.h"
+#include "utilities.h"
+
+#define COMPRESS_MAGIC  0x314352504d43524fULL   /* "ORCMPRC1" */
+#define COMPRESS_PROBE  4096    /* first read of an extent not in the index */
+#define COMPRESS_FILES  64      /* files open at once */
+
+enum { CODEC_ZLIB = 1, CODEC_LZ4, CODEC_ZSTD };
+
+typedef struct {
+        unsigned long long magic;
+        unsigned long long length;      /* bytes of the transfer */
+        unsigned long long stored;      /* compressed bytes after the header */
+        unsigned long long codec;
+} compress_header_t;
+
+typedef struct {
+        unsigned long long file;        /* hash of the file name, 0 if free */
+        IOR_offset_t offset;
+        IOR_offset_t size;              /* bytes stored at offset */
+} compress_extent_t;
+
+/**************************** P R O T O T Y P E S *****************************/
+static void *COMPRESS_Create(char *, IOR_param_t *);
+static void *COMPRESS_Open(char *, IOR_param_t *);
+static IOR_offset_t COMPRESS_Xfer(int, void *, IOR_size_t *,
+                                  IOR_offset_t, IOR_param_t *);
+static void COMPRESS_Close(void *, IOR_param_t *);
+static void COMPRESS_Delete(char *, IOR_param_t *);
+static void COMPRESS_SetVersion(IOR_param_t *);
+static void COMPRESS_Fsync(void *, IOR_param_t *);
+static IOR_offset_t COMPRESS_GetFileSize(IOR_param_t *, MPI_Comm, char *);
+
+/************************** D E C L A R A T I O N S ***************************/
+
+ior_aiori_t compress_aiori = {
+        "compress",
+        COMPRESS_Create,
+        COMPRESS_Open,
+        COMPRESS_Xfer,
+        COMPRESS_Close,
+        COMPRESS_Delete,
+        COMPRESS_SetVersion,
+        COMPRESS_Fsync,
+        COMPRESS_GetFileSize,
+
+        NULL
+};
+
+#define below (compress_aiori.next)     /* the aiori doing the I/O */
+
+static struct {
+        void *fd;
+        unsigned long long file;
+        IOR_offset_t end;               /* end of the extents written */
+        IOR_offset_t stored;            /* end of the bytes stored */
+} files[COMPRESS_FILES];
+
+static compress_extent_t *extents;
+static size_t extentSlots, extentCount;
+
+static unsigned char *scratch;
+static IOR_offset_t scratchSize;
+
+static struct {
+        IOR_offset_t logical;
+        IOR_offset_t physical;
+        double cpu;
+} stats;
+
+/***************************** F U N C T I O N S ******************************/
+
+/*
+ * Return the codec number of a compressor name, or fail if ior was built
+ * without it.
+ */
+int COMPRESS_Codec(char *name)
+{
+        if (strcasecmp(name, "zlib") == 0) {
+#if defined(HAVE_ZLIB_H) && defined(HAVE_LIBZ)
+                return (CODEC_ZLIB);
+#else
+                ERR("ior was not compiled with zlib");
+#endif
+        } else if (strcasecmp(name, "lz4") == 0) {
+#if defined(HAVE_LZ4_H) && defined(HAVE_LIBLZ4)
+                return (CODEC_LZ4);
+#else
+                ERR("ior was not compiled with lz4");
+#endif
+        } else if (strcasecmp(name, "zstd") == 0) {
+#if defined(HAVE_ZSTD_H) && defined(HAVE_LIBZSTD)
+                return (CODEC_ZSTD);
+#else
+                ERR("ior was not compiled with zstd");
+#endif
+        }
+        ERR("compressor must be zlib, lz4, or zstd");
+        return (0);
+}
+
+/*
+ * Return the bytes moved since the counts were reset, before and after
+ * compression, and the CPU time spent compressing them.
+ */
+void COMPRESS_Stats(IOR_offset_t * logical, IOR_offset_t * physical,
+                    double *cpu)
+{
+        *logical = stats.logical;
+        *physical = stats.physical;
+        *cpu = stats.cpu;
+}
+
+void COMPRESS_StatsReset(void)
+{
+        memset(&stats, 0, sizeof(stats));
+}
+
+static double CpuTime(void)
+{
+        struct timespec ts;
+
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+                ERR("cannot get CPU time");
+        return (ts.tv_sec + ts.tv_nsec / 1.0e9);
+}
+
+static unsigned long long FileHash(char *name)
+{
+        unsigned long long h = 0xcbf29ce484222325ULL;   /* FNV-1a */
+
+        for (; *name != '\0'; name++)
+                h = (h ^ (unsigned char)*name) * 0x100000001b3ULL;
+        return (h == 0 ? 1 : h);
+}
+
+static int FileSlot(void *fd)
+{
+        int i;
+
+        for (i = 0; i < COMPRESS_FILES; i++)
+                if (files[i].fd == fd)
+                        return (i);
+        return (-1);
+}
+
+static void *FileTrack(void *fd, char *name)
+{
+        int i = FileSlot(NULL);
+
+        if (i < 0)
+                ERR("too many files open in compression stage");
+        files[i].fd = fd;
+        files[i].file = FileHash(name);
+        files[i].end = files[i].stored = 0;
+        return (fd);
+}
+
+static compress_extent_t *ExtentFind(unsigned long long file,
+                                     IOR_offset_t offset)
+{
+        size_t i;
+
+        i = (size_t)((file ^ (unsigned long long)offset
+                      * 0x9e3779b97f4a7c15ULL) % extentSlots);
+        while (extents[i].file != 0
+               && (extents[i].file != file || extents[i].offset != offset))
+                i = (i + 1) % extentSlots;
+        return (&extents[i]);
+}
+
+static IOR_offset_t ExtentGet(unsigned long long file, IOR_offset_t offset)
+{
+        if (extentCount == 0)
+                return (0);
+        return (ExtentFind(file, offset)->size);
+}
+
+static void ExtentSet(unsigned long long file, IOR_offset_t offset,
+                      IOR_offset_t size)
+{
+        compress_extent_t *old = extents, *e;
+        size_t i, oldSlots = extentSlots;
+
+        /* keep the table at most half full */
+        if (2 * (extentCount + 1) > extentSlots) {
+                extentSlots = extentSlots ? 2 * extentSlots : 4096;
+                extents = (compress_extent_t *)calloc(extentSlots,
+                                                      sizeof(compress_extent_t));
+                if (extents == NULL)
+                        ERR("calloc failed");
+                for (i = 0; i < oldSlots; i++)
+                        if (old[i].file != 0)
+                                *ExtentFind(old[i].file, old[i].offset) = old[i];
+                free(old);
+        }
+        e = ExtentFind(file, offset);
+        if (e->file == 0)
+                extentCount++;
+        e->file = file;
+        e->offset = offset;
+        e->size = size;
+}
+
+static void ScratchSetup(IOR_offset_t size)
+{
+        if (size <= scratchSize)
+                return;
+        free(scratch);
+        scratch = (unsigned char *)malloc(size);
+        if (scratch == NULL)
+                ERR("malloc failed");
+        scratchSize = size;
+}
+
+/*
+ * Compress into at most cap bytes; returns the compressed size, or 0 if the
+ * data does not fit.
+ */
+static IOR_offset_t Compress(int codec, int level, void *dst, IOR_offset_t cap,
+                             void *src, IOR_offset_t length)
+{
+        switch (codec) {
+#if defined(HAVE_ZLIB_H) && defined(HAVE_LIBZ)
+        case CODEC_ZLIB: {
+                uLongf size = cap;
+
+                if (compress2((Bytef *)dst, &size, (Bytef *)src, length,
+                              level ? level : Z_DEFAULT_COMPRESSION) != Z_OK)
+                        return (0);
+                return (size);
+        }
+#endif
+#if defined(HAVE_LZ4_H) && defined(HAVE_LIBLZ4)
+        case CODEC_LZ4:
+                /* the level is lz4's acceleration */
+                return (LZ4_compress_fast((char *)src, (char *)dst, length,
+                                          cap, level > 0 ? level : 1));
+#endif
+#if defined(HAVE_ZSTD_H) && defined(HAVE_LIBZSTD)
+        case CODEC_ZSTD: {
+                size_t size = ZSTD_compress(dst, cap, src, length,
+                                            level ? level : ZSTD_CLEVEL_DEFAULT);
+
+                return (ZSTD_isError(size) ? 0 : size);
+        }
+#endif
+        }
+        return (0);
+}
+
+static int Decompress(int codec, void *dst, IOR_offset_t length, void *src,
+                      IOR_offset_t stored)
+{
+        switch (codec) {
+#if defined(HAVE_ZLIB_H) && defined(HAVE_LIBZ)
+        case CODEC_ZLIB: {
+                uLongf size = length;
+
+                return (uncompress((Bytef *)dst, &size, (Bytef *)src,
+                                   stored) == Z_OK && size == (uLongf)length);
+        }
+#endif
+#if defined(HAVE_LZ4_H) && defined(HAVE_LIBLZ4)
+        case CODEC_LZ4:
+                return (LZ4_decompress_safe((char *)src, (char *)dst, stored,
+                                            length) == length);
+#endif
+#if defined(HAVE_ZSTD_H) && defined(HAVE_LIBZSTD)
+        case CODEC_ZSTD:
+                return (ZSTD_decompress(dst, length, src, stored) == length);
+#endif
+        }
+        return (FALSE);
+}
+
+/*
+ * Move bytes through the backend at an offset other than param->offset.
+ */
+static void XferAt(int access, void *fd, void *buffer, IOR_offset_t length,
+                   IOR_offset_t offset, IOR_param_t * param)
+{
+        IOR_offset_t saved = param->offset;
+
+        param->offset = offset;
+        if (below->xfer(access, fd, (IOR_size_t *)buffer, length, param)
+            != length)
+                ERR(access == WRITE ? "cannot write to file"
+                                    : "cannot read from file");
+        param->offset = saved;
+}
+
+static void *COMPRESS_Create(char *testFileName, IOR_param_t * param)
+{
+        return (FileTrack(below->create(testFileName, param), testFileName));
+}
+
+static void *COMPRESS_Open(char *testFileName, IOR_param_t * param)
+{
+        return (FileTrack(below->open(testFileName, param), testFileName));
+}
+
+static IOR_offset_t COMPRESS_Xfer(int access, void *fd, IOR_size_t * buffer,
+                                  IOR_offset_t length, IOR_param_t * param)
+{
+        compress_header_t *header;
+        IOR_offset_t offset = param->offset, stored = 0, total;
+        int codec = COMPRESS_Codec(param->compressor);
+        int i = FileSlot(fd);
+        double cpu;
+
+        if (i < 0)
+                ERR("file not opened through compression stage");
+        ScratchSetup(length);
+        header = (compress_header_t *)scratch;
+
+        if (access == WRITE) {
+                cpu = CpuTime();
+                if (length > (IOR_offset_t)sizeof(compress_header_t))
+                        stored = Compress(codec, param->compressLevel,
+                                          scratch + sizeof(compress_header_t),
+                                          length - sizeof(compress_header_t),
+                                          buffer, length);
+                stats.cpu += CpuTime() - cpu;
+                if (stored > 0) {
+                        header->magic = COMPRESS_MAGIC;
+                        header->length = length;
+                        header->stored = stored;
+                        header->codec = codec;
+                        total = sizeof(compress_header_t) + stored;
+                        XferAt(WRITE, fd, scratch, total, offset, param);
+                } else {
+                        total = length;
+                        XferAt(WRITE, fd, buffer, total, offset, param);
+                }
+                ExtentSet(files[i].file, offset, total);
+                files[i].end = MAX(files[i].end, offset + length);
+                files[i].stored = MAX(files[i].stored, offset + total);
+                stats.logical += length;
+                stats.physical += total;
+                return (length);
+        }
+
+        /* the index is a hint: what is read decides how it is decoded */
+        total = ExtentGet(files[i].file, offset);
+        if (total <= 0 || total > length)
+                total = MIN(length, COMPRESS_PROBE);
+        XferAt(access, fd, scratch, total, offset, param);
+        if (total >= (IOR_offset_t)sizeof(compress_header_t)
+            && header->magic == COMPRESS_MAGIC
+            && header->length == (unsigned long long)length
+            && header->stored <= length - sizeof(compress_header_t)) {
+                stored = sizeof(compress_header_t) + header->stored;
+                if (stored > total) {
+                        XferAt(access, fd, scratch + total, stored - total,
+                               offset + total, param);
+                        total = stored;
+                }
+                cpu = CpuTime();
+                if (!Decompress((int)header->codec, buffer, length,
+                                scratch + sizeof(compress_header_t),
+                                header->stored))
+                        ERR("cannot decompress transfer");
+                stats.cpu += CpuTime() - cpu;
+        } else {
+                /* stored as is */
+                memcpy(buffer, scratch, total);
+                if (total < length)
+                        XferAt(access, fd, (char *)buffer + total,
+                               length - total, offset + total, param);
+                total = length;
+        }
+        stats.logical += length;
+        stats.physical += total;
+        return (length);
+}
+
+static void COMPRESS_Close(void *fd, IOR_param_t * param)
+{
+        char zero = 0;
+        int i = FileSlot(fd);
+
+        /* the file ends where its last transfer would, not where its
+           last record does */
+        if (i >= 0 && files[i].stored < files[i].end)
+                XferAt(WRITE, fd, &zero, 1, files[i].end - 1, param);
+        if (i >= 0)
+                files[i].fd = NULL;
+        below->close(fd, param);
+}
+
+static void COMPRESS_Delete(char *testFileName, IOR_param_t * param)
+{
+        below->delete(testFileName, param);
+}
+
+static void COMPRESS_SetVersion(IOR_param_t * param)
+{
+        LayerSetVersion(&compress_aiori, param);
+}
+
+static void COMPRESS_Fsync(void *fd, IOR_param_t * param)
+{
+        below->fsync(fd, param);
+}
+
+static IOR_offset_t COMPRESS_GetFileSize(IOR_param_t * param,
+                                         MPI_Comm testComm, char *testFileName)
+{
+        return (below->get_file_size(param, testComm, testFileName));
+}
@@ -0,0 +1,221 @@
+/* -*- mode: c; c-basic-offset: 8; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=8:tabstop=8:
+ */
+/******************************************************************************\
+*                                                                              *
+*        Copyright (c) 2003, The Regents of the University of California       *
+*      See the file COPYRIGHT for a complete copyright notice and license.     *
+*                                                                              *
+********************************************************************************
+*
+* Delay and throttle layers of the abstract I/O interface.  Stacked on a
+* backend, "delay" adds latency to every call made to the aiori below it, and
+* "throttle" holds each task's transfers to a bandwidth.
+*
+\******************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>               /* nanosleep() */
+
+#include "ior.h"
+#include "aiori.h"
+#include "iordef.h"
+#include "utilities.h"
+
+/**************************** P R O T O T Y P E S *****************************/
+static void *DELAY_Create(char *, IOR_param_t *);
+static void *DELAY_Open(char *, IOR_param_t *);
+static IOR_offset_t DELAY_Xfer(int, void *, IOR_size_t *,
+                               IOR_offset_t, IOR_param_t *);
+static void DELAY_Close(void *, IOR_param_t *);
+static void DELAY_Delete(char *, IOR_param_t *);
+static void DELAY_SetVersion(IOR_param_t *);
+static void DELAY_Fsync(void *, IOR_param_t *);
+static IOR_offset_t DELAY_GetFileSize(IOR_param_t *, MPI_Comm, char *);
+
+static void *THROTTLE_Create(char *, IOR_param_t *);
+static void *THROTTLE_Open(char *, IOR_param_t *);
+static IOR_offset_t THROTTLE_Xfer(int, void *, IOR_size_t *,
+                                  IOR_offset_t, IOR_param_t *);
+static void THROTTLE_Close(void *, IOR_param_t *);
+static void THROTTLE_Delete(char *, IOR_param_t *);
+static void THROTTLE_SetVersion(IOR_param_t *);
+static void THROTTLE_Fsync(void *, IOR_param_t *);
+static IOR_offset_t THROTTLE_GetFileSize(IOR_param_t *, MPI_Comm, char *);
+
+/************************** D E C L A R A T I O N S ***************************/
+
+ior_aiori_t delay_aiori = {
+        "delay",
+        DELAY_Create,
+        DELAY_Open,
+        DELAY_Xfer,
+        DELAY_Close,
+        DELAY_Delete,
+        DELAY_SetVersion,
+        DELAY_Fsync,
+        DELAY_GetFileSize,
+
+        NULL
+};
+
+ior_aiori_t throttle_aiori = {
+        "throttle",
+        THROTTLE_Create,
+        THROTTLE_Open,
+        THROTTLE_Xfer,
+        THROTTLE_Close,
+        THROTTLE_Delete,
+        THROTTLE_SetVersion,
+        THROTTLE_Fsync,
+        THROTTLE_GetFileSize,
+
+        NULL
+};
+
+static unsigned int jitterSeed;
+static double throttleNext;             /* when the next transfer may end */
+
+/***************************** F U N C T I O N S ******************************/
+
+static void SleepFor(double seconds)
+{
+        struct timespec ts;
+
+        if (seconds <= 0)
+                return;
+        ts.tv_sec = (time_t)seconds;
+        ts.tv_nsec = (long)((seconds - ts.tv_sec) * 1.0e9);
+        while (nanosleep(&ts, &ts) != 0)
+                if (errno != EINTR)
+                        ERR("nanosleep() failed");
+}
+
+/*
+ * Wait delayLatency seconds, plus up to delayJitter more, before a call.
+ */
+static void Delay(IOR_param_t * param)
+{
+        double jitter = 0;
+
+        if (param->delayJitter > 0) {
+                if (jitterSeed == 0)
+                        jitterSeed = rank + 1;
+                jitter = param->delayJitter * rand_r(&jitterSeed)
+                         / ((double)RAND_MAX + 1);
+        }
+        SleepFor(param->delayLatency + jitter);
+}
+
+static void *DELAY_Create(char *testFileName, IOR_param_t * param)
+{
+        Delay(param);
+        return (delay_aiori.next->create(testFileName, param));
+}
+
+static void *DELAY_Open(char *testFileName, IOR_param_t * param)
+{
+        Delay(param);
+        return (delay_aiori.next->open(testFileName, param));
+}
+
+static IOR_offset_t DELAY_Xfer(int access, void *fd, IOR_size_t * buffer,
+                               IOR_offset_t length, IOR_param_t * param)
+{
+        Delay(param);
+        return (delay_aiori.next->xfer(access, fd, buffer, length, param));
+}
+
+static void DELAY_Close(void *fd, IOR_param_t * param)
+{
+        Delay(param);
+        delay_aiori.next->close(fd, param);
+}
+
+static void DELAY_Delete(char *testFileName, IOR_param_t * param)
+{
+        Delay(param);
+        delay_aiori.next->delete(testFileName, param);
+}
+
+static void DELAY_SetVersion(IOR_param_t * param)
+{
+        LayerSetVersion(&delay_aiori, param);
+}
+
+static void DELAY_Fsync(void *fd, IOR_param_t * param)
+{
+        Delay(param);
+        delay_aiori.next->fsync(fd, param);
+}
+
+static IOR_offset_t DELAY_GetFileSize(IOR_param_t * param, MPI_Comm testComm,
+                                      char *testFileName)
+{
+        Delay(param);
+        return (delay_aiori.next->get_file_size(param, testComm,
+                                                testFileName));
+}
+
+static void *THROTTLE_Create(char *testFileName, IOR_param_t * param)
+{
+        return (throttle_aiori.next->create(testFileName, param));
+}
+
+static void *THROTTLE_Open(char *testFileName, IOR_param_t * param)
+{
+        return (throttle_aiori.next->open(testFileName, param));
+}
+
+/*
+ * Hold a transfer until throttleBandwidth allows it to have ended.  Idle
+ * time earns no credit, so transfers after a pause are not let through in
+ * a burst.
+ */
+static IOR_offset_t THROTTLE_Xfer(int access, void *fd, IOR_size_t * buffer,
+                                  IOR_offset_t length, IOR_param_t * param)
+{
+        IOR_offset_t rc;
+        double now = MPI_Wtime();
+
+        if (throttleNext < now)
+                throttleNext = now;
+        throttleNext += (double)length / param->throttleBandwidth;
+        rc = throttle_aiori.next->xfer(access, fd, buffer, length, param);
+        SleepFor(throttleNext - MPI_Wtime());
+        return (rc);
+}
+
+static void THROTTLE_Close(void *fd, IOR_param_t * param)
+{
+        throttle_aiori.next->close(fd, param);
+}
+
+static void THROTTLE_Delete(char *testFileName, IOR_param_t * param)
+{
+        throttle_aiori.next->delete(testFileName, param);
+}
+
+static void THROTTLE_SetVersion(IOR_param_t * param)
+{
+        LayerSetVersion(&throttle_aiori, param);
+}
+
+static void THROTTLE_Fsync(void *fd, IOR_param_t * param)
+{
+        throttle_aiori.next->fsync(fd, param);
+}
+
+static IOR_offset_t THROTTLE_GetFileSize(IOR_param_t * param,
+                                         MPI_Comm testComm, char *testFileName)
+{
+        return (throttle_aiori.next->get_file_size(param, testComm,
+                                                   testFileName));
+}
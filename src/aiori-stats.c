@@ -0,0 +1,205 @@
+/* -*- mode: c; c-basic-offset: 8; indent-tabs-mode: nil; -*-
+ * vim:expandtab:shiftwidth=8:tabstop=8:
+ */
+/******************************************************************************\
+*                                                                              *
+*        Copyright (c) 2003, The Regents of the University of California       *
+*      See the file COPYRIGHT for a complete copyright notice and license.     *
+*                                                                              *
+********************************************************************************
+*
+* Statistics layer of the abstract I/O interface.  Stacked on a backend with
+* "-a stats:<api>", it counts the calls made to the aiori below it, with
+* their latency and the bytes transferred, and reports them for each test.
+*
+\******************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ior.h"
+#include "aiori.h"
+#include "iordef.h"
+#include "utilities.h"
+
+enum {
+        STATS_CREATE,
+        STATS_OPEN,
+        STATS_WRITE,
+        STATS_READ,
+        STATS_CLOSE,
+        STATS_DELETE,
+        STATS_FSYNC,
+        STATS_GET_FILE_SIZE,
+        STATS_CALLS
+};
+
+static char *callNames[STATS_CALLS] = {
+        "create", "open", "xfer write", "xfer read", "close", "delete",
+        "fsync", "get_file_size"
+};
+
+/**************************** P R O T O T Y P E S *****************************/
+static void *STATS_Create(char *, IOR_param_t *);
+static void *STATS_Open(char *, IOR_param_t *);
+static IOR_offset_t STATS_Xfer(int, void *, IOR_size_t *,
+                               IOR_offset_t, IOR_param_t *);
+static void STATS_Close(void *, IOR_param_t *);
+static void STATS_Delete(char *, IOR_param_t *);
+static void STATS_SetVersion(IOR_param_t *);
+static void STATS_Fsync(void *, IOR_param_t *);
+static IOR_offset_t STATS_GetFileSize(IOR_param_t *, MPI_Comm, char *);
+
+/************************** D E C L A R A T I O N S ***************************/
+
+ior_aiori_t stats_aiori = {
+        "stats",
+        STATS_Create,
+        STATS_Open,
+        STATS_Xfer,
+        STATS_Close,
+        STATS_Delete,
+        STATS_SetVersion,
+        STATS_Fsync,
+        STATS_GetFileSize,
+
+        NULL
+};
+
+#define below (stats_aiori.next)
+
+static struct {
+        long long count[STATS_CALLS];
+        long long bytes[STATS_CALLS];
+        double time[STATS_CALLS];
+        double max[STATS_CALLS];
+} stats;
+
+/***************************** F U N C T I O N S ******************************/
+
+static void Account(int call, double start, IOR_offset_t bytes)
+{
+        double elapsed = MPI_Wtime() - start;
+
+        stats.count[call]++;
+        stats.bytes[call] += bytes;
+        stats.time[call] += elapsed;
+        if (elapsed > stats.max[call])
+                stats.max[call] = elapsed;
+}
+
+/*
+ * Print the calls made since the last report, summed over the tasks of the
+ * test, with the longest single call of any task; the counts restart.
+ */
+void STATS_Report(void)
+{
+        long long count[STATS_CALLS], bytes[STATS_CALLS];
+        double time[STATS_CALLS], max[STATS_CALLS];
+        int i;
+
+        MPI_CHECK(MPI_Reduce(stats.count, count, STATS_CALLS,
+                             MPI_LONG_LONG_INT, MPI_SUM, 0, testComm),
+                  "cannot reduce call counts");
+        MPI_CHECK(MPI_Reduce(stats.bytes, bytes, STATS_CALLS,
+                             MPI_LONG_LONG_INT, MPI_SUM, 0, testComm),
+                  "cannot reduce call bytes");
+        MPI_CHECK(MPI_Reduce(stats.time, time, STATS_CALLS, MPI_DOUBLE,
+                             MPI_SUM, 0, testComm),
+                  "cannot reduce call times");
+        MPI_CHECK(MPI_Reduce(stats.max, max, STATS_CALLS, MPI_DOUBLE,
+                             MPI_MAX, 0, testComm),
+                  "cannot reduce call times");
+        memset(&stats, 0, sizeof(stats));
+        if (rank != 0 || verbose < VERBOSE_0)
+                return;
+
+        fprintf(stdout, "\n%-10s %-14s %10s %11s %11s %11s %11s\n", "stats:",
+                "call", "count", "mean(s)", "max(s)", "total(s)", "MiB");
+        for (i = 0; i < STATS_CALLS; i++) {
+                if (count[i] == 0)
+                        continue;
+                fprintf(stdout, "%-10s %-14s %10lld %11.6f %11.6f %11.6f",
+                        "", callNames[i], count[i], time[i] / count[i],
+                        max[i], time[i]);
+                if (i == STATS_WRITE || i == STATS_READ)
+                        fprintf(stdout, " %11.2f\n",
+                                (double)bytes[i] / MEBIBYTE);
+                else
+                        fprintf(stdout, " %11s\n", "-");
+        }
+        fflush(stdout);
+}
+
+static void *STATS_Create(char *testFileName, IOR_param_t * param)
+{
+        double start = MPI_Wtime();
+        void *fd = below->create(testFileName, param);
+
+        Account(STATS_CREATE, start, 0);
+        return (fd);
+}
+
+static void *STATS_Open(char *testFileName, IOR_param_t * param)
+{
+        double start = MPI_Wtime();
+        void *fd = below->open(testFileName, param);
+
+        Account(STATS_OPEN, start, 0);
+        return (fd);
+}
+
+static IOR_offset_t STATS_Xfer(int access, void *fd, IOR_size_t * buffer,
+                               IOR_offset_t length, IOR_param_t * param)
+{
+        double start = MPI_Wtime();
+        IOR_offset_t rc = below->xfer(access, fd, buffer, length, param);
+
+        Account(access == WRITE ? STATS_WRITE : STATS_READ, start, rc);
+        return (rc);
+}
+
+static void STATS_Close(void *fd, IOR_param_t * param)
+{
+        double start = MPI_Wtime();
+
+        below->close(fd, param);
+        Account(STATS_CLOSE, start, 0);
+}
+
+static void STATS_Delete(char *testFileName, IOR_param_t * param)
+{
+        double start = MPI_Wtime();
+
+        below->delete(testFileName, param);
+        Account(STATS_DELETE, start, 0);
+}
+
+static void STATS_SetVersion(IOR_param_t * param)
+{
+        LayerSetVersion(&stats_aiori, param);
+}
+
+static void STATS_Fsync(void *fd, IOR_param_t * param)
+{
+        double start = MPI_Wtime();
+
+        below->fsync(fd, param);
+        Account(STATS_FSYNC, start, 0);
+}
+
+static IOR_offset_t STATS_GetFileSize(IOR_param_t * param, MPI_Comm testComm,
+                                      char *testFileName)
+{
+        double start = MPI_Wtime();
+        IOR_offset_t size = below->get_file_size(param, testComm,
+                                                 testFileName);
+
+        Account(STATS_GET_FILE_SIZE, start, 0);
+        return (size);
+}
@@ -61,6 +61,7 @@ typedef struct ior_aiori {
         void (*set_version)(IOR_param_t *);
         void (*fsync)(void *, IOR_param_t *);
         IOR_offset_t (*get_file_size)(IOR_param_t *, MPI_Comm, char *);
+        struct ior_aiori *next;         /* for a layer, the aiori below it */
 } ior_aiori_t;
 
 extern ior_aiori_t hdf5_aiori;
@@ -68,13 +69,33 @@ extern ior_aiori_t hdfs_aiori;
 extern ior_aiori_t mpiio_aiori;
 extern ior_aiori_t ncmpi_aiori;
 extern ior_aiori_t posix_aiori;
+extern ior_aiori_t mem_aiori;
 extern ior_aiori_t plfs_aiori;
 extern ior_aiori_t s3_aiori;
 extern ior_aiori_t s3_plus_aiori;
 extern ior_aiori_t s3_emc_aiori;
+extern ior_aiori_t compress_aiori;
+extern ior_aiori_t stats_aiori;
+extern ior_aiori_t delay_aiori;
+extern ior_aiori_t throttle_aiori;
 
 
 IOR_offset_t MPIIO_GetFileSize(IOR_param_t * test, MPI_Comm testComm,
                                char *testFileName);
+void MPIIO_Wait(IOR_param_t * test);
+IOR_offset_t MPIIO_XferBatch(int access, void *fd, IOR_size_t * buffer,
+                             IOR_offset_t * offsets, int count,
+                             IOR_param_t * test);
+int COMPRESS_Codec(char *name);
+void COMPRESS_Stats(IOR_offset_t * logical, IOR_offset_t * physical,
+                    double *cpu);
+void COMPRESS_StatsReset(void);
+void STATS_Report(void);
+IOR_offset_t MEM_Ops(void);
+void MEM_OpsReset(void);
+double MPIIO_SharedPointerCost(IOR_param_t * test, char *testFileName,
+                               int access, IOR_offset_t * calls,
+                               double *callTime);
+void LayerSetVersion(ior_aiori_t * layer, IOR_param_t * param);
 
 #endif /* not _AIORI_H */
@@ -17,10 +17,22 @@
 #include <unistd.h>
 #include <ctype.h>              /* tolower() */
 #include <errno.h>
+#ifdef __linux__
+# define __USE_GNU               /* O_DIRECT */
+# include <fcntl.h>
+# undef __USE_GNU
+#endif
+#include <fcntl.h>              /* posix_fadvise() */
+#include <limits.h>             /* INT_MAX */
 #include <math.h>
 #include <mpi.h>
+#include <pthread.h>
 #include <string.h>
+#include <sys/mman.h>           /* mincore(), mmap() */
 #include <sys/stat.h>           /* struct stat */
+#ifdef __linux__
+# include <sys/syscall.h>        /* SYS_mbind, SYS_getcpu */
+#endif
 #include <time.h>
 
 #ifndef _WIN32
@@ -29,6 +41,9 @@
 #endif
 
 #include <assert.h>
+#if defined(HAVE_ZLIB_H) && defined(HAVE_LIBZ)
+# include <zlib.h>               /* compress2(), data ratio estimate */
+#endif
 
 #include "ior.h"
 #include "aiori.h"
@@ -43,12 +58,20 @@ int      rankOffset = 0;
 int      tasksPerNode = 0;           /* tasks per node */
 int      verbose = VERBOSE_0;        /* verbose output */
 MPI_Comm testComm;
+static int testCommTasks = 0;           /* tasks in the cached testComm */
+static int testCommTasksPerNode = 0;
+MPI_Comm fileComm = MPI_COMM_NULL;  /* tasks sharing this task's file */
 
 /* file scope globals */
 extern char **environ;
 int totalErrorCount = 0;
 double wall_clock_delta = 0;
 double wall_clock_deviation;
+int virtualIndex = 0;                /* virtual rank whose file is named */
+void **virtualFd = NULL;             /* handles of this task's virtual ranks */
+static int warmingUp = FALSE;        /* in an uncounted warm-up rep */
+static int topologyOffset = 0;       /* rankOffset for topology read back */
+static int mpiThreadLevel = MPI_THREAD_SINGLE; /* thread support provided */
 
 ior_aiori_t *backend;
 ior_aiori_t *available_aiori[] = {
@@ -68,6 +91,9 @@ ior_aiori_t *available_aiori[] = {
 #ifdef USE_POSIX_AIORI
         &posix_aiori,
 #endif
+#ifdef USE_MEM_AIORI
+        &mem_aiori,
+#endif
 #ifdef USE_PLFS_AIORI
         &plfs_aiori,
 #endif
@@ -79,6 +105,16 @@ ior_aiori_t *available_aiori[] = {
         NULL
 };
 
+/* layers that decorate a backend and forward to the one below; the
+   compressor option stacks compress_aiori directly on the backend */
+ior_aiori_t *available_layers[] = {
+        &stats_aiori,
+        &delay_aiori,
+        &throttle_aiori,
+        NULL
+};
+
+static int BackendHasCollective(char *);
 static void DestroyTests(IOR_test_t *tests_head);
 static void DisplayUsage(char **);
 static void GetTestFileName(char *, IOR_param_t *);
@@ -88,11 +124,39 @@ static void PrintEarlyHeader();
 static void PrintHeader(int argc, char **argv);
 static IOR_test_t *SetupTests(int, char **);
 static void ShowTestInfo(IOR_param_t *);
+static void SharedPointerPrintCost(IOR_param_t *, char *, double, int);
+static void DataRatioEstimate(IOR_param_t *);
+static void PipelinePrintBlocked(double, int);
+static void CompressPrintStats(double, int);
+static void MemPrintOps(IOR_param_t *, double, int);
+static void SleepFor(double);
+static void BurstStart(IOR_param_t *);
+static void BurstBegin(void);
+static void BurstEnd(IOR_param_t *);
+static void PaceStart(IOR_param_t *);
+static double PaceWait(IOR_param_t *);
+static void PaceDone(IOR_param_t *, double);
+static void PacePrint(IOR_test_t *, double, int);
+static double PaceQuantile(long long *, double, double);
 static void ShowSetup(IOR_param_t *params);
 static void ShowTest(IOR_param_t *);
 static void PrintLongSummaryAllTests(IOR_test_t *tests_head);
+static void PrintSweepMatrix(IOR_test_t *tests_head);
+static double TestBandwidth(IOR_test_t *, double *, double *);
+static void TestCommFree(void);
+static void CachePairTests(IOR_test_t *, IOR_test_t *);
+static void SetCacheState(char *, IOR_param_t *);
+static void TopologyReorder(IOR_param_t *);
+static int RepetitionsConverged(IOR_test_t *, int);
+static void XferBuffersRelease(void);
+static int TasksPerFile(IOR_param_t *);
 static void TestIoSys(IOR_test_t *);
+static void TuneHints(IOR_test_t *);
+static int TwoPhaseAggregatorCount(IOR_param_t *);
 static void ValidateTests(IOR_param_t *);
+static void WorkQueueFree(void);
+static void WorkQueuePrintShare(IOR_param_t *, double, int);
+static void WorkQueueSetup(IOR_param_t *);
 static IOR_offset_t WriteOrRead(IOR_param_t * test, void *fd, int access, IOR_io_buffers* ioBuffers);
 static void WriteTimes(IOR_param_t *, double **, int, int);
 
@@ -124,7 +188,10 @@ int main(int argc, char **argv)
 #endif
 
         /* start the MPI code */
-        MPI_CHECK(MPI_Init(&argc, &argv), "cannot initialize MPI");
+        /* only the main thread calls MPI; a fillPipeline helper does not */
+        MPI_CHECK(MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED,
+                                  &mpiThreadLevel),
+                  "cannot initialize MPI");
         MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &numTasksWorld),
                   "cannot get number of tasks");
         MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank), "cannot get rank");
@@ -170,13 +237,17 @@ int main(int argc, char **argv)
                         printf("\trank %d: awake.\n", rank);
                 }
 
-                TestIoSys(tptr);
+                if (tptr->params.hintSearchFile[0] != '\0')
+                        TuneHints(tptr);
+                else
+                        TestIoSys(tptr);
         }
 
         if (verbose < 0)
                 /* always print final summary */
                 verbose = 0;
         PrintLongSummaryAllTests(tests_head);
+        PrintSweepMatrix(tests_head);
 
         /* display finish time */
         if (rank == 0 && verbose >= VERBOSE_0) {
@@ -185,6 +256,8 @@ int main(int argc, char **argv)
         }
 
         DestroyTests(tests_head);
+        XferBuffersRelease();
+        TestCommFree();
 
         MPI_CHECK(MPI_Finalize(), "cannot finalize MPI");
 
@@ -216,7 +289,13 @@ void init_IOR_Param_t(IOR_param_t * p)
 
         p->nodes = 1;
         p->tasksPerNode = 1;
+        p->virtualRanks = 1;
+        p->elementSize = sizeof(IOR_size_t);
         p->repetitions = 1;
+        p->minRepetitions = 3;
+        p->bufferPool = 1;
+        p->dedupBlockSize = 4096;
+        p->memCopy = 1;
         p->repCounter = -1;
         p->open = WRITE;
         p->taskPerNodeOffset = 1;
@@ -225,6 +304,8 @@ void init_IOR_Param_t(IOR_param_t * p)
         p->transferSize = 262144;
         p->randomSeed = -1;
         p->incompressibleSeed = 573;
+        p->twoPhaseBufferSize = 16 * MEBIBYTE;
+        p->randomBatch = 16;
         p->testComm = MPI_COMM_WORLD;
         p->setAlignment = 1;
         p->lustre_start_ost = -1;
@@ -246,11 +327,13 @@ void init_IOR_Param_t(IOR_param_t * p)
 
 /*
  * Bind the global "backend" pointer to the requested backend AIORI's
- * function table.
+ * function table, under any decorator layers named before it ("-a
+ * stats:delay:POSIX"), the first named outermost.
  */
 static void AioriBind(char* api, IOR_param_t* param)
 {
         ior_aiori_t **tmp;
+        char layers[MAX_STR], *name;
 
         backend = NULL;
         for (tmp = available_aiori; *tmp != NULL; tmp++) {
@@ -270,6 +353,46 @@ static void AioriBind(char* api, IOR_param_t* param)
                         param->curl_flags &= ~(IOR_CURL_S3_EMC_EXT);
         }
 
+        for (tmp = available_layers; *tmp != NULL; tmp++)
+                (*tmp)->next = NULL;
+        compress_aiori.next = NULL;
+        if (param->compressor[0] != '\0') {
+                compress_aiori.next = backend;
+                backend = &compress_aiori;
+        }
+        strcpy(layers, param->apiLayers);
+        while (layers[0] != '\0') {
+                name = strrchr(layers, ':');
+                name = (name == NULL) ? layers : name + 1;
+                for (tmp = available_layers; *tmp != NULL; tmp++)
+                        if (strcmp(name, (*tmp)->name) == 0)
+                                break;
+                if (*tmp == NULL)
+                        ERR("unrecognized API layer");
+                if ((*tmp)->next != NULL)
+                        ERR("API layer stacked twice");
+                (*tmp)->next = backend;
+                backend = *tmp;
+                if (name == layers)
+                        layers[0] = '\0';
+                else
+                        name[-1] = '\0';
+        }
+}
+
+/*
+ * Set a layer's version string: its name before that of the aiori below.
+ */
+void LayerSetVersion(ior_aiori_t * layer, IOR_param_t * param)
+{
+        /* room for the layer name and the full version below it */
+        char version[2 * MAX_STR];
+
+        layer->next->set_version(param);
+        snprintf(version, sizeof(version), "%s:%s", layer->name,
+                 param->apiVersion);
+        strncpy(param->apiVersion, version, MAX_STR - 1);
+        param->apiVersion[MAX_STR - 1] = '\0';
 }
 
 static void
@@ -639,6 +762,14 @@ void AllocResults(IOR_test_t *test)
         if (test->results->aggFileSizeForBW == NULL)
                 ERR("malloc of aggFileSizeForBW failed");
 
+        test->results->paceHist =
+                (long long *)malloc(2 * PACE_BUCKETS * sizeof(long long));
+        if (test->results->paceHist == NULL)
+                ERR("malloc of paceHist failed");
+        memset(test->results->paceHist, 0,
+               2 * PACE_BUCKETS * sizeof(long long));
+        test->results->paceMax[0] = test->results->paceMax[1] = 0;
+
 }
 
 void FreeResults(IOR_test_t *test)
@@ -647,6 +778,7 @@ void FreeResults(IOR_test_t *test)
                 free(test->results->aggFileSizeFromStat);
                 free(test->results->aggFileSizeFromXfer);
                 free(test->results->aggFileSizeForBW);
+                free(test->results->paceHist);
                 free(test->results->readTime);
                 free(test->results->writeTime);
                 free(test->results);
@@ -741,11 +873,11 @@ static void DisplayUsage(char **argv)
 {
         char *opts[] = {
                 "OPTIONS:",
-                " -a S  api --  API for I/O [POSIX|MPIIO|HDF5|HDFS|S3|S3_EMC|NCMPI]",
+                " -a S  api --  API for I/O [POSIX|MPIIO|HDF5|HDFS|S3|S3_EMC|NCMPI|MEM], after any layers [stats:delay:throttle:]",
                 " -A N  refNum -- user supplied reference number to include in the summary",
                 " -b N  blockSize -- contiguous bytes to write per task  (e.g.: 8, 4k, 2m, 1g)",
                 " -B    useO_DIRECT -- uses O_DIRECT for POSIX, bypassing I/O buffers",
-                " -c    collective -- collective I/O",
+                " -c    collective -- collective I/O (two-phase in IOR for POSIX, HDFS, S3)",
                 " -C    reorderTasks -- changes task ordering to n+1 ordering for readback",
                 " -d N  interTestDelay -- delay between reps in seconds",
                 " -D N  deadlineForStonewalling -- seconds before stopping write or read phase",
@@ -777,7 +909,7 @@ static void DisplayUsage(char **argv)
                 " -r    readFile -- read existing file",
                 " -R    checkRead -- check read after read",
                 " -s N  segmentCount -- number of segments",
-                " -S    useStridedDatatype -- put strided access into datatype [not working]",
+                " -S    useStridedDatatype -- put strided access into datatype",
                 " -t N  transferSize -- size of transfer in bytes (e.g.: 8, 4k, 2m, 1g)",
                 " -T N  maxTimeDuration -- max time in minutes for each test",
                 " -u    uniqueDir -- use unique directory name for each file-per-process",
@@ -870,6 +1002,76 @@ FillIncompressibleBuffer(void* buffer, IOR_param_t * test)
         
 }
 
+/*
+ * Tunable data.  Each dedupBlockSize block of a task's data is either its own
+ * or, for a 1 - 1/dedupRatio share of blocks, a copy of one of a small pool of
+ * blocks common to all tasks.  Within a block, a 1/compressRatio share of
+ * runs is random and the rest repeat a single byte.  The data is a function
+ * of the seed, the task and the file offset only, so checks can regenerate it.
+ */
+#define DEDUP_POOL_BLOCKS 64
+#define COMPRESS_RUN      256
+
+static unsigned long long Mix64(unsigned long long x)
+{
+        /* splitmix64 */
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+}
+
+static double Unit(unsigned long long x)
+{
+        return (double)(x >> 11) / 9007199254740992.0;  /* 2^53 */
+}
+
+static void FillTunableBlock(unsigned long long *buf, size_t words,
+                             unsigned long long key, double compressRatio)
+{
+        double share = compressRatio > 1 ? 1.0 / compressRatio : 1.0;
+        double acc = Unit(Mix64(~key));    /* random phase, exact mean */
+        unsigned long long state = key, fill;
+        size_t i, j, n;
+
+        for (i = 0; i < words; i += n) {
+                n = COMPRESS_RUN / sizeof(unsigned long long);
+                if (n > words - i)
+                        n = words - i;
+                acc += share;
+                if (acc >= 1.0) {
+                        acc -= 1.0;
+                        for (j = 0; j < n; j++)
+                                buf[i + j] = Mix64(state++);
+                } else {
+                        fill = (Mix64(state++) & 0xff) * 0x0101010101010101ULL;
+                        for (j = 0; j < n; j++)
+                                buf[i + j] = fill;
+                }
+        }
+}
+
+static void FillTunableBuffer(void *buffer, IOR_param_t * test,
+                              unsigned long long offset, int fillrank)
+{
+        double dupShare = test->dedupRatio > 1 ? 1.0 - 1.0 / test->dedupRatio : 0;
+        unsigned long long seed = Mix64(test->timeStampSignatureValue);
+        unsigned long long task = Mix64(seed + fillrank);
+        unsigned long long id, key;
+        size_t words = test->dedupBlockSize / sizeof(unsigned long long);
+        IOR_offset_t i;
+
+        for (i = 0; i < test->transferSize; i += test->dedupBlockSize) {
+                id = Mix64(task + (offset + i) / test->dedupBlockSize);
+                if (Unit(id) < dupShare)
+                        key = Mix64(~seed + id % DEDUP_POOL_BLOCKS);
+                else
+                        key = id;
+                FillTunableBlock((unsigned long long *)((char *)buffer + i),
+                                 words, key, test->compressRatio);
+        }
+}
+
 unsigned int reseed_incompressible_prng = TRUE;
 
 static void
@@ -889,6 +1091,10 @@ FillBuffer(void *buffer,
                 }
                 FillIncompressibleBuffer(buffer, test);
         }
+
+        else if (test->dataPacketType == tunable) {
+                FillTunableBuffer(buffer, test, offset, fillrank);
+        }
  
         else {
                 hi = ((unsigned long long)fillrank) << 32;
@@ -956,6 +1162,11 @@ static void GetTestFileName(char *testFileName, IOR_param_t * test)
         char   testFileNameRoot[MAX_STR];
         char   tmpString[MAX_STR];
         int count;
+        int fileRank;
+
+        /* file number, counting virtual ranks */
+        fileRank = ((rank + rankOffset) % test->numTasks) * test->virtualRanks
+                   + virtualIndex;
 
         /* parse filename for multiple file systems */
         strcpy(initialTestFileName, test->testFileName);
@@ -964,8 +1175,11 @@ static void GetTestFileName(char *testFileName, IOR_param_t * test)
                 ERR("cannot use multiple file names with unique directories");
         if (test->filePerProc) {
                 strcpy(testFileNameRoot,
-                       fileNames[((rank +
-                                   rankOffset) % test->numTasks) % count]);
+                       fileNames[fileRank % count]);
+        } else if (test->tasksPerFile) {
+                fileRank = ((rank + rankOffset) % test->numTasks)
+                           / test->tasksPerFile;
+                strcpy(testFileNameRoot, fileNames[fileRank % count]);
         } else {
                 strcpy(testFileNameRoot, fileNames[0]);
         }
@@ -980,8 +1194,10 @@ static void GetTestFileName(char *testFileName, IOR_param_t * test)
                         strcpy(testFileNameRoot,
                                PrependDir(test, testFileNameRoot));
                 }
-                sprintf(testFileName, "%s.%08d", testFileNameRoot,
-                        (rank + rankOffset) % test->numTasks);
+                sprintf(testFileName, "%s.%08d", testFileNameRoot, fileRank);
+        } else if (test->tasksPerFile) {
+                /* one file per group of tasks */
+                sprintf(testFileName, "%s.%08d", testFileNameRoot, fileRank);
         } else {
                 strcpy(testFileName, testFileNameRoot);
         }
@@ -1324,7 +1540,10 @@ static void ReduceIterResults(IOR_test_t *test, double **timer, int rep,
   PPDouble(LEFT, diff_subset[1], " ");
   PPDouble(LEFT, diff_subset[2], " ");
   PPDouble(LEFT, totalTime, " ");
-  fprintf(stdout, "%-4d\n", rep);
+  if (warmingUp)
+    fprintf(stdout, "%-4s\n", "warm");
+  else
+    fprintf(stdout, "%-4d\n", rep);
 
   fflush(stdout);
 }
@@ -1336,7 +1555,10 @@ static void PrintRemoveTiming(double start, double finish, int rep)
 
         printf("remove    -          -          -          -          -          -          ");
         PPDouble(1, finish-start, " ");
-        printf("%-4d\n", rep);
+        if (warmingUp)
+                printf("%-4s\n", "warm");
+        else
+                printf("%-4d\n", rep);
 }
 
 /*
@@ -1353,7 +1575,8 @@ static void RemoveFile(char *testFileName, int filePerProc, IOR_param_t * test)
                         rankOffset = 0;
                         GetTestFileName(testFileName, test);
                 }
-                if (access(testFileName, F_OK) == 0) {
+                if (strcmp(test->api, "MEM") == 0
+                    || access(testFileName, F_OK) == 0) {
                         backend->delete(testFileName, test);
                 }
                 if (test->reorderTasksRandom == TRUE) {
@@ -1367,12 +1590,134 @@ static void RemoveFile(char *testFileName, int filePerProc, IOR_param_t * test)
                 //      something to safely check for existence of the
                 //      "file".
                 //      
-                if ((rank == 0) && (access(testFileName, F_OK) == 0)) {
+                if (strcmp(test->api, "MEM") == 0) {
+                        /* memory files are per node, and mapped by each
+                           task; the next create must not race a removal */
+                        backend->delete(testFileName, test);
+                        MPI_CHECK(MPI_Barrier(testComm), "barrier error");
+                } else if ((rank == 0) && (access(testFileName, F_OK) == 0)) {
                         backend->delete(testFileName, test);
                 }
         }
 }
 
+/*
+ * Set fileComm to the tasks accessing the same file as this one, which for
+ * tasksPerFile groups depends on the current rankOffset.
+ */
+static void SetupFileComm(IOR_param_t * test)
+{
+        int pretendRank = (rank + rankOffset) % test->numTasks;
+
+        if (fileComm != MPI_COMM_NULL && fileComm != testComm)
+                MPI_CHECK(MPI_Comm_free(&fileComm), "MPI_Comm_free() error");
+        if (test->tasksPerFile == 0 || test->filePerProc) {
+                fileComm = testComm;
+                return;
+        }
+        MPI_CHECK(MPI_Comm_split(testComm, pretendRank / test->tasksPerFile,
+                                 pretendRank, &fileComm),
+                  "cannot split communicator by file");
+}
+
+/*
+ * Remove the test file(s), including one per virtual rank if file-per-proc.
+ */
+static void RemoveTestFiles(char *testFileName, IOR_param_t * test)
+{
+        int tmpRankOffset;
+
+        if (test->tasksPerFile && !test->filePerProc) {
+                /* the first task of each group removes the group's file */
+                tmpRankOffset = rankOffset;
+                rankOffset = 0;
+                GetTestFileName(testFileName, test);
+                if (strcmp(test->api, "MEM") == 0)
+                        backend->delete(testFileName, test);
+                else if ((rank % test->tasksPerFile == 0)
+                    && (access(testFileName, F_OK) == 0))
+                        backend->delete(testFileName, test);
+                rankOffset = tmpRankOffset;
+                GetTestFileName(testFileName, test);
+                return;
+        }
+        if (test->virtualRanks == 1 || !test->filePerProc) {
+                RemoveFile(testFileName, test->filePerProc, test);
+                return;
+        }
+        for (virtualIndex = 0; virtualIndex < test->virtualRanks;
+             virtualIndex++) {
+                GetTestFileName(testFileName, test);
+                RemoveFile(testFileName, TRUE, test);
+        }
+        virtualIndex = 0;
+        GetTestFileName(testFileName, test);
+}
+
+/*
+ * Create or open the test file(s), with one handle per virtual rank kept in
+ * virtualFd[].  The handle of the first virtual rank is returned.
+ */
+static void *OpenTestFiles(char *testFileName, IOR_param_t * test, int create)
+{
+        if (test->virtualRanks == 1)
+                return create ? backend->create(testFileName, test)
+                              : backend->open(testFileName, test);
+
+        for (virtualIndex = 0; virtualIndex < test->virtualRanks;
+             virtualIndex++) {
+                GetTestFileName(testFileName, test);
+                virtualFd[virtualIndex] =
+                        create ? backend->create(testFileName, test)
+                               : backend->open(testFileName, test);
+        }
+        virtualIndex = 0;
+        GetTestFileName(testFileName, test);
+        return virtualFd[0];
+}
+
+static void CloseTestFiles(void *fd, IOR_param_t * test)
+{
+        int k;
+
+        if (test->virtualRanks == 1) {
+                backend->close(fd, test);
+                return;
+        }
+        for (k = 0; k < test->virtualRanks; k++)
+                backend->close(virtualFd[k], test);
+}
+
+/*
+ * Aggregate size of the test file(s), summing all virtual ranks' files.
+ */
+static IOR_offset_t GetTestFilesSize(char *testFileName, IOR_param_t * test)
+{
+        IOR_offset_t aggFileSize = 0;
+
+        if (test->tasksPerFile && !test->filePerProc) {
+                /* each task counts its group's file once per member */
+                aggFileSize = backend->get_file_size(test, fileComm,
+                                                     testFileName);
+                MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &aggFileSize, 1,
+                                        MPI_LONG_LONG_INT, MPI_SUM, testComm),
+                          "cannot total file sizes");
+                return aggFileSize / test->tasksPerFile;
+        }
+        if (test->virtualRanks == 1 || !test->filePerProc)
+                return backend->get_file_size(test, testComm, testFileName);
+
+        for (virtualIndex = 0; virtualIndex < test->virtualRanks;
+             virtualIndex++) {
+                GetTestFileName(testFileName, test);
+                aggFileSize += backend->get_file_size(test, testComm,
+                                                      testFileName);
+        }
+        virtualIndex = 0;
+        GetTestFileName(testFileName, test);
+        return aggFileSize;
+}
+
 /*
  * Determine any spread (range) between node times.
  */
@@ -1423,6 +1768,8 @@ static IOR_test_t *SetupTests(int argc, char **argv)
         /* check validity of tests and create test queue */
         while (tests != NULL) {
                 ValidateTests(&tests->params);
+                if (tests->params.cacheMode == cache_both)
+                        CachePairTests(testsHead, tests);
                 tests = tests->next;
         }
 
@@ -1435,44 +1782,603 @@ static IOR_test_t *SetupTests(int argc, char **argv)
         return (testsHead);
 }
 
+/*
+ * Replace a test of cacheMode 'both' by a cold and a warm test, adding the
+ * mode to its sweep (or making a sweep of the two) so the summary shows the
+ * pair side by side.  Later tests are renumbered.
+ */
+static void CachePairTests(IOR_test_t *testsHead, IOR_test_t *test)
+{
+        IOR_test_t *warm, *tptr;
+        int id, sweepId = 0;
+        size_t len;
+
+        for (tptr = testsHead; tptr != NULL; tptr = tptr->next)
+                sweepId = MAX(sweepId, tptr->params.sweepId);
+        if (test->params.sweepId == 0) {
+                test->params.sweepId = sweepId + 1;
+                test->params.sweepLabel[0] = '\0';
+        }
+        len = strlen(test->params.sweepLabel);
+        snprintf(&test->params.sweepLabel[len], MAX_STR - len, "%s%s",
+                 len > 0 ? " " : "", "cacheMode=cold");
+        test->params.cacheMode = cache_cold;
+
+        warm = CreateTest(&test->params, test->params.id + 1);
+        strcpy(&warm->params.sweepLabel[strlen(warm->params.sweepLabel)
+                                        - strlen("cold")], "warm");
+        warm->params.cacheMode = cache_warm;
+        AllocResults(warm);
+        warm->next = test->next;
+        test->next = warm;
+
+        for (id = warm->params.id, tptr = warm; tptr != NULL;
+             tptr = tptr->next)
+                tptr->params.id = id++;
+}
+
+/*
+ * This task's share of a test file of 'size' bytes: all of its own file,
+ * or an equal part of a shared one.
+ */
+static void CacheShare(IOR_param_t *params, IOR_offset_t size,
+                       IOR_offset_t *first, IOR_offset_t *last)
+{
+        int fileTasks = 1, fileRank = 0;
+
+        if (!params->filePerProc && fileComm != MPI_COMM_NULL) {
+                MPI_CHECK(MPI_Comm_size(fileComm, &fileTasks),
+                          "cannot get file tasks");
+                MPI_CHECK(MPI_Comm_rank(fileComm, &fileRank),
+                          "cannot get file rank");
+        }
+        *first = size / fileTasks * fileRank;
+        *last = fileRank == fileTasks - 1 ? size
+                : size / fileTasks * (fileRank + 1);
+}
+
+/*
+ * Bytes of [first, last) of an open file resident in this node's page
+ * cache, from mincore() on a mapping of it.
+ */
+static IOR_offset_t CacheResident(int fd, IOR_offset_t first,
+                                  IOR_offset_t last)
+{
+        IOR_offset_t pageSize = getpagesize();
+        IOR_offset_t start = first - first % pageSize;
+        IOR_offset_t resident = 0, i, pages;
+        unsigned char *vec;
+        void *map;
+
+        if (last <= first)
+                return 0;
+        pages = (last - start + pageSize - 1) / pageSize;
+        map = mmap(NULL, last - start, PROT_READ, MAP_SHARED, fd, start);
+        if (map == MAP_FAILED) {
+                WARN("cannot map test file to check its residency");
+                return 0;
+        }
+        vec = (unsigned char *)malloc(pages);
+        if (vec == NULL)
+                ERR("malloc failed");
+        if (mincore(map, last - start, vec) == 0) {
+                for (i = 0; i < pages; i++)
+                        if (vec[i] & 1)
+                                resident += pageSize;
+        } else {
+                WARN("mincore() of test file failed");
+        }
+        free(vec);
+        munmap(map, last - start);
+        return MIN(resident, last - first);
+}
+
+/*
+ * Put the file about to be read in the page cache state of the test: cold
+ * flushes it and drops it from this node's cache (and, where permitted, all
+ * clean caches), warm reads this task's share of it in first.  Then report
+ * how much of the file(s) the read phase will find cached.
+ */
+static void SetCacheState(char *testFileName, IOR_param_t *params)
+{
+        char *buffer;
+        struct stat statBuf;
+        IOR_offset_t first, last, offset;
+        IOR_offset_t local[2] = { 0, 0 }, total[2] = { 0, 0 };
+        ssize_t rc;
+        MPI_Comm nodeComm;
+        int fd, drop, nodeRank = 0;
+
+        if (params->cacheMode == cache_cold) {
+                /* one task per node drops the caches */
+                MPI_CHECK(MPI_Comm_split_type(testComm, MPI_COMM_TYPE_SHARED,
+                                              rank, MPI_INFO_NULL, &nodeComm),
+                          "cannot split communicator by node");
+                MPI_CHECK(MPI_Comm_rank(nodeComm, &nodeRank),
+                          "cannot get rank");
+                MPI_CHECK(MPI_Comm_free(&nodeComm), "MPI_Comm_free() error");
+        }
+        fd = open(testFileName, O_RDONLY);
+        if (fd < 0 || fstat(fd, &statBuf) != 0) {
+                WARN("cannot open test file to set its cache state");
+                if (fd >= 0)
+                        close(fd);
+                fd = -1;
+        }
+        if (fd >= 0 && params->cacheMode == cache_cold) {
+                if (fdatasync(fd) != 0 && verbose >= VERBOSE_2)
+                        WARN("fdatasync() of test file failed");
+                if (posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) != 0)
+                        WARN("posix_fadvise() of test file failed");
+                if (nodeRank == 0) {
+                        /* needs privilege; the fadvise() must do otherwise */
+                        drop = open("/proc/sys/vm/drop_caches", O_WRONLY);
+                        if (drop >= 0) {
+                                sync();
+                                if (write(drop, "3", 1) != 1
+                                    && verbose >= VERBOSE_2)
+                                        WARN("cannot drop caches");
+                                close(drop);
+                        }
+                }
+        }
+        if (fd >= 0) {
+                CacheShare(params, statBuf.st_size, &first, &last);
+        }
+        if (fd >= 0 && params->cacheMode == cache_warm) {
+                buffer = (char *)malloc(MEBIBYTE);
+                if (buffer == NULL)
+                        ERR("malloc failed");
+                for (offset = first; offset < last; offset += rc) {
+                        rc = pread(fd, buffer, MIN(MEBIBYTE, last - offset),
+                                   offset);
+                        if (rc <= 0) {
+                                WARN("cannot pre-read test file");
+                                break;
+                        }
+                }
+                free(buffer);
+        }
+        if (fd >= 0) {
+                local[0] = CacheResident(fd, first, last);
+                local[1] = last - first;
+                close(fd);
+        }
+
+        MPI_CHECK(MPI_Reduce(local, total, 2, MPI_LONG_LONG_INT, MPI_SUM, 0,
+                             testComm), "cannot reduce cache residency");
+        if (rank == 0 && verbose >= VERBOSE_0 && total[1] > 0) {
+                fprintf(stdout, "%-10s%.1f%% of %s resident before read\n",
+                        "cached", 100.0 * total[0] / total[1],
+                        HumanReadable(total[1], BASE_TWO));
+                if (params->cacheMode == cache_cold
+                    && total[0] > total[1] / 100)
+                        WARN("test file still cached, read may not reach storage");
+        }
+}
+
+#ifndef MAP_HUGE_SHIFT
+# define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MPOL_BIND
+# define MPOL_BIND 2
+#endif
+
+/*
+ * NUMA node for buffers: 'local' (the node this task runs on), a node
+ * number, or the node of a network or block device (e.g., 'ib0', 'nvme0n1')
+ * from sysfs.  Returns -1 if unknown.
+ */
+static int BufferNumaNode(char *spec)
+{
+        static const char *paths[] = {
+                "/sys/class/net/%s/device/numa_node",
+                "/sys/class/infiniband/%s/device/numa_node",
+                "/sys/class/block/%s/device/numa_node",
+                "/sys/class/block/%s/device/device/numa_node"
+        };
+        char path[MAXPATHLEN];
+        unsigned cpu, node = 0;
+        int found = -1;
+        size_t i;
+        FILE *file;
+
+        if (strcasecmp(spec, "local") == 0) {
+#if defined(__linux__) && defined(SYS_getcpu)
+                if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+                        return (int)node;
+#endif
+                return -1;
+        }
+        if (isdigit(spec[0]))
+                return atoi(spec);
+        for (i = 0; i < sizeof(paths) / sizeof(paths[0]) && found < 0; i++) {
+                snprintf(path, MAXPATHLEN, paths[i], spec);
+                file = fopen(path, "r");
+                if (file == NULL)
+                        continue;
+                if (fscanf(file, "%d", &found) != 1)
+                        found = -1;
+                fclose(file);
+        }
+        return found;
+}
+
+/*
+ * Allocate a transfer buffer of at least '*size' bytes placed as the test
+ * asks: on huge pages, bound to a NUMA node, locked.  '*size' is set to the
+ * mapped length.  Failures to place it are warned of if 'warn' is set.
+ * Returns NULL if no placement is asked for.
+ */
+static void *PlacedBufferAlloc(size_t *size, IOR_param_t *test, int warn)
+{
+        size_t pageSize = getpagesize();
+        unsigned long nodeMask;
+        void *buf = MAP_FAILED;
+        int node;
+
+        if (test->hugePages == 0 && test->bufferNuma[0] == '\0'
+            && !test->lockBuffers)
+                return NULL;
+
+#ifdef MAP_HUGETLB
+        if (test->hugePages > 0) {
+                *size = (*size + test->hugePages - 1) / test->hugePages
+                        * test->hugePages;
+                buf = mmap(NULL, *size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB
+                           | ((int)log2((double)test->hugePages)
+                              << MAP_HUGE_SHIFT), -1, 0);
+                if (buf == MAP_FAILED && warn)
+                        WARN("no huge pages of that size reserved, using transparent huge pages");
+        }
+#endif
+        if (buf == MAP_FAILED) {
+                *size = (*size + pageSize - 1) / pageSize * pageSize;
+                buf = mmap(NULL, *size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (buf == MAP_FAILED)
+                        ERR("cannot map transfer buffer");
+#ifdef MADV_HUGEPAGE
+                if (test->hugePages != 0
+                    && madvise(buf, *size, MADV_HUGEPAGE) != 0 && warn)
+                        WARN("cannot use transparent huge pages");
+#endif
+        }
+
+        /* bind before the buffer is first touched */
+        if (test->bufferNuma[0] != '\0') {
+                node = BufferNumaNode(test->bufferNuma);
+#if defined(__linux__) && defined(SYS_mbind)
+                if (node >= 0 && (size_t)node < 8 * sizeof(nodeMask)) {
+                        nodeMask = 1UL << node;
+                        if (syscall(SYS_mbind, buf, *size, MPOL_BIND,
+                                    &nodeMask, 8 * sizeof(nodeMask), 0) != 0
+                            && warn)
+                                WARN("cannot bind transfer buffer to NUMA node");
+                } else if (warn) {
+                        WARN("cannot find NUMA node for transfer buffer");
+                }
+#else
+                if (warn)
+                        WARN("NUMA binding of transfer buffers not supported");
+#endif
+        }
+
+        if (test->lockBuffers && mlock(buf, *size) != 0 && warn)
+                WARN("cannot lock transfer buffer (see ulimit -l)");
+        return buf;
+}
+
+#define PLACEMENT_STR (MAX_STR + 48)    /* huge pages, NUMA spec, lock flag */
+
+/*
+ * Transfer buffers kept from test to test, so that a sweep of many tests
+ * does not reallocate (and refault) them each time.  Buffers with a
+ * placement are mapped, and reallocated when the placement changes.
+ */
+static struct {
+        void *buffer[3];
+        size_t size[3];
+        int mapped[3];
+        char placement[PLACEMENT_STR];
+} xferCache;
+
+/*
+ * Return cached buffer 'which' of at least 'size' bytes.
+ */
+static void *XferBufferCached(int which, size_t size, IOR_param_t *test)
+{
+        char placement[PLACEMENT_STR];
+
+        snprintf(placement, PLACEMENT_STR, "%lld %s %d", test->hugePages,
+                 test->bufferNuma, test->lockBuffers);
+        if (strcmp(placement, xferCache.placement) != 0) {
+                XferBuffersRelease();
+                strcpy(xferCache.placement, placement);
+        }
+        if (xferCache.buffer[which] != NULL && xferCache.size[which] >= size)
+                return xferCache.buffer[which];
+        if (xferCache.buffer[which] != NULL) {
+                if (xferCache.mapped[which])
+                        munmap(xferCache.buffer[which], xferCache.size[which]);
+                else
+                        aligned_buffer_free(xferCache.buffer[which]);
+        }
+        xferCache.buffer[which] = PlacedBufferAlloc(&size, test,
+                                                     rank == 0 && which == 0);
+        xferCache.mapped[which] = xferCache.buffer[which] != NULL;
+        if (xferCache.buffer[which] == NULL)
+                xferCache.buffer[which] = aligned_buffer_alloc(size);
+        xferCache.size[which] = size;
+        return xferCache.buffer[which];
+}
+
+/*
+ * Rack of this task's host in a topology file of 'host rack' lines, as the
+ * index of the rack's first line; hosts not listed (or on a failure to read
+ * the file) get a rack of their own, -1 - 'node'.  The file is read by task
+ * 0 and broadcast.
+ */
+static int TopologyRack(char *topologyFile, int node)
+{
+        char host[MAX_STR], name[MAX_STR], rackName[MAX_STR];
+        char myRack[MAX_STR], *text = NULL, *line;
+        int size = 0, rack = -1 - node, lineNum, pass;
+        size_t dot;
+        FILE *file;
+
+        if (rank == 0) {
+                file = fopen(topologyFile, "r");
+                if (file == NULL) {
+                        WARN("cannot open topology file");
+                } else {
+                        fseek(file, 0, SEEK_END);
+                        size = ftell(file);
+                        rewind(file);
+                        text = (char *)malloc(size + 1);
+                        if (text == NULL)
+                                ERR("malloc failed");
+                        size = fread(text, 1, size, file);
+                        fclose(file);
+                }
+        }
+        MPI_CHECK(MPI_Bcast(&size, 1, MPI_INT, 0, testComm),
+                  "cannot broadcast topology file size");
+        if (rank != 0 || text == NULL) {
+                text = (char *)malloc(size + 1);
+                if (text == NULL)
+                        ERR("malloc failed");
+        }
+        MPI_CHECK(MPI_Bcast(text, size, MPI_CHAR, 0, testComm),
+                  "cannot broadcast topology file");
+        text[size] = '\0';
+
+        if (gethostname(host, MAX_STR) != 0)
+                host[0] = '\0';
+        dot = strcspn(host, ".");
+
+        /* find this host's rack, by full or short host name, then the
+           first line of that rack, which is the same for all its hosts */
+        myRack[0] = '\0';
+        for (pass = 0; pass < 2 && rack < 0; pass++) {
+                for (line = text, lineNum = 0; line != NULL;
+                     line = strchr(line, '\n'), lineNum++) {
+                        if (*line == '\n')
+                                line++;
+                        if (sscanf(line, " %[^#\n \t] %[^#\n \t\r]", name,
+                                   rackName) != 2)
+                                continue;
+                        if (pass == 0 && (strcmp(name, host) == 0
+                                          || (strlen(name) == dot
+                                              && strncmp(name, host, dot) == 0))) {
+                                strcpy(myRack, rackName);
+                                break;
+                        }
+                        if (pass == 1 && strcmp(rackName, myRack) == 0) {
+                                rack = lineNum;
+                                break;
+                        }
+                }
+                if (myRack[0] == '\0')
+                        break;
+        }
+        free(text);
+        return rack;
+}
+
+/*
+ * Order ranks by group, then rank.
+ */
+static int CompareGroupRanks(const void *a, const void *b)
+{
+        const int *x = (const int *)a, *y = (const int *)b;
+
+        if (x[0] != y[0])
+                return (x[0] > y[0]) - (x[0] < y[0]);
+        return (x[1] > y[1]) - (x[1] < y[1]);
+}
+
+/*
+ * List the 'n' ranks in 'order' as (group, rank) pairs, group by group.
+ * Returns the size of the largest group.
+ */
+static int GroupOrder(int n, int *groups, int *order, int *nGroups)
+{
+        int i, local = 1, largest = 1;
+
+        for (i = 0; i < n; i++) {
+                order[2 * i] = groups[i];
+                order[2 * i + 1] = i;
+        }
+        qsort(order, n, 2 * sizeof(int), CompareGroupRanks);
+        *nGroups = 1;
+        for (i = 1; i < n; i++) {
+                local = order[2 * i] == order[2 * i - 2] ? local + 1 : 1;
+                *nGroups += local == 1;
+                largest = MAX(largest, local);
+        }
+        return largest;
+}
+
+/*
+ * Set topologyOffset to read back, for any task placement, data written on
+ * another node (or rack, with a topology file).  Tasks are listed group by
+ * group and each reads the data of the task as many places further on as
+ * the largest group has tasks, which leaves every group as long as no group
+ * holds more than half of the tasks.
+ */
+static void TopologyReorder(IOR_param_t *params)
+{
+        MPI_Comm nodeComm;
+        int *groups, *order;
+        int n = params->numTasks, node, rack, i, shift, local, nGroups;
+        char *unit = "node";
+
+        /* a node is known by its lowest rank */
+        MPI_CHECK(MPI_Comm_split_type(testComm, MPI_COMM_TYPE_SHARED, rank,
+                                      MPI_INFO_NULL, &nodeComm),
+                  "cannot split node communicator");
+        node = rank;
+        MPI_CHECK(MPI_Bcast(&node, 1, MPI_INT, 0, nodeComm),
+                  "cannot broadcast node");
+        MPI_CHECK(MPI_Comm_free(&nodeComm), "MPI_Comm_free() error");
+
+        groups = (int *)malloc(n * sizeof(int));
+        order = (int *)malloc(2 * n * sizeof(int));
+        if (groups == NULL || order == NULL)
+                ERR("malloc failed");
+
+        shift = n;
+        if (params->topologyFile[0] != '\0') {
+                rack = TopologyRack(params->topologyFile, node);
+                MPI_CHECK(MPI_Allgather(&rack, 1, MPI_INT, groups, 1, MPI_INT,
+                                        testComm), "cannot gather racks");
+                shift = GroupOrder(n, groups, order, &nGroups);
+                unit = "rack";
+                if (2 * shift > n && rank == 0)
+                        WARN("a rack holds over half of the tasks, reading back from another node instead");
+        }
+        if (2 * shift > n) {
+                MPI_CHECK(MPI_Allgather(&node, 1, MPI_INT, groups, 1, MPI_INT,
+                                        testComm), "cannot gather nodes");
+                shift = GroupOrder(n, groups, order, &nGroups);
+                unit = "node";
+        }
+
+        /* this task reads the data of the task 'shift' places further on */
+        for (i = 0; order[2 * i + 1] != rank; i++) ;
+        topologyOffset = (order[2 * ((i + shift) % n) + 1] - rank + n) % n;
+
+        if (rank == 0 && verbose >= VERBOSE_1)
+                fprintf(stdout, "Reading back from another %s: %d %ss, "
+                        "largest of %d tasks\n", unit, nGroups, unit, shift);
+        if (rank == 0 && 2 * shift > n) {
+                for (i = 0, local = 0; i < n; i++)
+                        local += order[2 * i] == order[2 * ((i + shift) % n)];
+                fprintf(stdout, "WARNING: a %s holds over half of the tasks; "
+                        "%d of %d tasks read back data of their own %s.\n",
+                        unit, local, n, unit);
+        }
+        free(groups);
+        free(order);
+}
+
+/*
+ * Free the cached test communicator.
+ */
+static void TestCommFree(void)
+{
+        if (testCommTasks > 0 && testComm != MPI_COMM_NULL)
+                MPI_CHECK(MPI_Comm_free(&testComm), "MPI_Comm_free() error");
+        testComm = MPI_COMM_NULL;
+        testCommTasks = 0;
+}
+
+/*
+ * Fill the pool's buffers as if for successive transfers.  A strided
+ * datatype buffer holds every transfer of the task, each filled as
+ * StridedDatatypeXfer would fill it without stored offsets.
+ */
+static void XferBuffersFill(IOR_io_buffers* ioBuffers, IOR_param_t* test,
+                            int pretendRank)
+{
+        /* a strided datatype moves all of a task's transfers at once */
+        size_t size = test->useStridedDatatype ?
+                test->blockSize * test->segmentCount : test->transferSize;
+        size_t k;
+        int i;
+
+        for (i = 0; i < test->bufferPool; i++) {
+                if (!test->useStridedDatatype) {
+                        FillBuffer((char *)ioBuffers->buffer + i * size, test,
+                                   i * size, pretendRank);
+                        continue;
+                }
+                for (k = 0; k < size; k += test->transferSize)
+                        FillBuffer((char *)ioBuffers->buffer + i * size + k,
+                                   test, 0, pretendRank);
+        }
+}
+
 /*
  * Setup transfer buffers, creating and filling as needed.
  */
 static void XferBuffersSetup(IOR_io_buffers* ioBuffers, IOR_param_t* test, 
                              int pretendRank)
 {
-        ioBuffers->buffer = aligned_buffer_alloc(test->transferSize);
+        /* a strided datatype moves all of a task's transfers at once */
+        size_t size = test->useStridedDatatype ?
+                test->blockSize * test->segmentCount : test->transferSize;
 
-        FillBuffer(ioBuffers->buffer, test, 0, pretendRank);
+        ioBuffers->buffer = XferBufferCached(0, size * test->bufferPool, test);
+        XferBuffersFill(ioBuffers, test, pretendRank);
 
+        /* a fill pipeline reads into one check buffer while verifying the
+           other */
         if (test->checkWrite || test->checkRead) {
-                ioBuffers->checkBuffer = aligned_buffer_alloc(test->transferSize);
+                ioBuffers->checkBuffer = XferBufferCached(1, size
+                                                          * (test->fillPipeline ? 2 : 1),
+                                                          test);
         }
         if (test->checkRead) {
-                ioBuffers->readCheckBuffer = aligned_buffer_alloc(test->transferSize);
+                ioBuffers->readCheckBuffer = XferBufferCached(2, test->transferSize, test);
         }
 
         return;
 }
 
 /*
- * Free transfer buffers.
+ * Done with transfer buffers for this test; they stay cached for the next
+ * one until XferBuffersRelease().
  */
-static void XferBuffersFree(IOR_io_buffers* ioBuffers, IOR_param_t* test)
+static void XferBuffersFree(IOR_io_buffers* ioBuffers)
 
 {
-        aligned_buffer_free(ioBuffers->buffer);
-
-        if (test->checkWrite || test->checkRead) {
-                aligned_buffer_free(ioBuffers->checkBuffer);
-        }
-        if (test->checkRead) {
-                aligned_buffer_free(ioBuffers->readCheckBuffer);
-        }
+        ioBuffers->buffer = NULL;
+        ioBuffers->checkBuffer = NULL;
+        ioBuffers->readCheckBuffer = NULL;
 
         return;
 }
 
+/*
+ * Release the cached transfer buffers.
+ */
+static void XferBuffersRelease(void)
+{
+        int i;
+
+        for (i = 0; i < 3; i++) {
+                if (xferCache.buffer[i] != NULL && xferCache.mapped[i])
+                        munmap(xferCache.buffer[i], xferCache.size[i]);
+                else if (xferCache.buffer[i] != NULL)
+                        aligned_buffer_free(xferCache.buffer[i]);
+                xferCache.buffer[i] = NULL;
+                xferCache.size[i] = 0;
+        }
+}
+
 
 /*
  * Message to print immediately after MPI_Init so we know that
@@ -1547,6 +2453,9 @@ static void ShowTestInfo(IOR_param_t *params)
 {
         fprintf(stdout, "\n");
         fprintf(stdout, "Test %d started: %s", params->id, CurrentTimeString());
+        if (params->sweepId != 0)
+                fprintf(stdout, "Sweep %d: %s\n", params->sweepId,
+                        params->sweepLabel);
         if (verbose >= VERBOSE_1) {
                 /* if pvfs2:, then skip */
                 if (Regex(params->testFileName, "^[a-z][a-z].*:") == 0) {
@@ -1570,11 +2479,35 @@ static void ShowSetup(IOR_param_t *params)
         printf("\tapi                = %s\n", params->apiVersion);
         printf("\ttest filename      = %s\n", params->testFileName);
         printf("\taccess             = ");
-        printf(params->filePerProc ? "file-per-process" : "single-shared-file");
-        if (verbose >= VERBOSE_1 && strcmp(params->api, "POSIX") != 0) {
+        if (params->filePerProc) {
+                printf("file-per-process");
+        } else if (params->tasksPerFile) {
+                printf("file-per-%d-tasks", params->tasksPerFile);
+        } else {
+                printf("single-shared-file");
+        }
+        if (params->workStealing) {
+                printf(", work stealing");
+        } else if (params->twoPhase) {
+                printf(", two-phase");
+        } else if (verbose >= VERBOSE_1 && strcmp(params->api, "POSIX") != 0) {
                 printf(params->collective == FALSE ? ", independent" : ", collective");
         }
         printf("\n");
+        if (params->twoPhase) {
+                printf("\taggregators        = %d\n",
+                       TwoPhaseAggregatorCount(params));
+                printf("\tcollective buffer  = %s\n",
+                       HumanReadable(params->twoPhaseBufferSize, BASE_TWO));
+        }
+        if (params->nonblockingWindow > 0) {
+                printf("\tnonblocking        = %d requests in flight\n",
+                       params->nonblockingWindow);
+        }
+        if (params->workStealing) {
+                printf("\twork counters      = %s\n",
+                       params->workStealingPerNode ? "one per node" : "one");
+        }
         if (verbose >= VERBOSE_1) {
                 if (params->segmentCount > 1) {
                         fprintf(stdout,
@@ -1586,15 +2519,48 @@ static void ShowSetup(IOR_param_t *params)
                 }
         }
         printf("\tordering in a file =");
-        if (params->randomOffset == FALSE) {
+        if (params->subarrayDims > 0) {
+                int d;
+                printf(" subarray of ");
+                for (d = 0; d < params->subarrayDims; d++)
+                        printf(d ? "x%d" : "%d", params->globalDims[d]);
+                printf(" elements of %d bytes, task grid ",
+                       params->elementSize);
+                for (d = 0; d < params->subarrayDims; d++)
+                        printf(d ? "x%d" : "%d", params->processGrid[d]);
+                printf("\n");
+        } else if (params->useSharedFilePointer) {
+                printf(" shared file pointer, %s\n",
+                       params->collective ? "ordered appends"
+                                          : "unordered appends");
+        } else if (params->randomOffset == FALSE) {
                 printf(" sequential offsets\n");
+        } else if (params->collective
+                   && strcmp(params->api, "MPIIO") == 0) {
+                printf(" random offsets, collective rounds of %d transfers\n",
+                       params->randomBatch);
         } else {
                 printf(" random offsets\n");
         }
+        if (params->writerTasks > 0) {
+                printf("\trestart            = written by %d tasks, ",
+                       params->writerTasks);
+                if (params->restartBlockSize == 0)
+                        printf("read in even shares\n");
+                else
+                        printf("read in %s blocks\n",
+                               HumanReadable(params->restartBlockSize,
+                                             BASE_TWO));
+        }
         printf("\tordering inter file=");
-        if (params->reorderTasks == FALSE && params->reorderTasksRandom == FALSE) {
+        if (params->reorderTasks == FALSE && params->reorderTasksRandom == FALSE
+            && params->reorderTasksTopology == FALSE) {
                 printf(" no tasks offsets\n");
         }
+        if (params->reorderTasksTopology == TRUE) {
+                printf(" read back from another %s\n",
+                       params->topologyFile[0] != '\0' ? "rack" : "node");
+        }
         if (params->reorderTasks == TRUE) {
                 printf(" constant task offsets = %d\n",
                         params->taskPerNodeOffset);
@@ -1603,15 +2569,97 @@ static void ShowSetup(IOR_param_t *params)
                 printf(" random task offsets >= %d, seed=%d\n",
                         params->taskPerNodeOffset, params->reorderTasksRandomSeed);
         }
-        printf("\tclients            = %d (%d per node)\n",
-                params->numTasks, params->tasksPerNode);
+        if (params->virtualRanks > 1) {
+                printf("\tclients            = %d (%d per node), virtual\n",
+                       params->numTasks * params->virtualRanks,
+                       params->tasksPerNode * params->virtualRanks);
+                printf("\tvirtual ranks      = %d per task on %d tasks\n",
+                       params->virtualRanks, params->numTasks);
+        } else {
+                printf("\tclients            = %d (%d per node)\n",
+                       params->numTasks, params->tasksPerNode);
+        }
         if (params->memoryPerTask != 0)
                 printf("\tmemoryPerTask      = %s\n",
                        HumanReadable(params->memoryPerTask, BASE_TWO));
         if (params->memoryPerNode != 0)
                 printf("\tmemoryPerNode      = %s\n",
                        HumanReadable(params->memoryPerNode, BASE_TWO));
-        printf("\trepetitions        = %d\n", params->repetitions);
+        if (params->hugePages != 0 || params->bufferNuma[0] != '\0'
+            || params->lockBuffers) {
+                printf("\tbuffers            = ");
+                if (params->hugePages == -1)
+                        printf("transparent huge pages");
+                else if (params->hugePages > 0)
+                        printf("%s huge pages",
+                               HumanReadable(params->hugePages, BASE_TWO));
+                else
+                        printf("base pages");
+                if (params->bufferNuma[0] != '\0')
+                        printf(", NUMA node %s", params->bufferNuma);
+                if (params->lockBuffers)
+                        printf(", locked");
+                printf("\n");
+        }
+        if (params->bufferPool > 1)
+                printf("\tbuffer pool        = %d buffers, %s\n",
+                       params->bufferPool,
+                       HumanReadable(params->bufferPool
+                                     * params->transferSize, BASE_TWO));
+        if (params->dataPacketType == tunable)
+                printf("\tdata               = compress %.2f:1, dedup %.2f:1, "
+                       "%lld-byte blocks\n",
+                       params->compressRatio > 1 ? params->compressRatio : 1.0,
+                       params->dedupRatio > 1 ? params->dedupRatio : 1.0,
+                       params->dedupBlockSize);
+        if (strstr(params->apiLayers, "delay") != NULL)
+                printf("\tdelay              = %g s per call, up to %g s more\n",
+                       params->delayLatency, params->delayJitter);
+        if (strstr(params->apiLayers, "throttle") != NULL)
+                printf("\tthrottle           = %s/s per task\n",
+                       HumanReadable(params->throttleBandwidth, BASE_TWO));
+        if (params->paceRate > 0 || params->paceBandwidth > 0) {
+                printf("\tpace               = %s loop, ",
+                       params->paceLoop == pace_open ? "open" : "closed");
+                if (params->paceBandwidth > 0)
+                        printf("%s/s", HumanReadable(params->paceBandwidth,
+                                                     BASE_TWO));
+                else
+                        printf("%g ops/s", params->paceRate);
+                printf(" %s\n", params->paceAggregate ? "in all" : "per task");
+        }
+        if (params->burstSize > 0)
+                printf("\tbursts             = %s per task, then %g s of %s\n",
+                       HumanReadable(params->burstSize, BASE_TWO),
+                       params->computeTime,
+                       params->computeBurn ? "memory burner" : "sleep");
+        if (strcmp(params->api, "MEM") == 0)
+                printf("\tmemory copy        = %s\n",
+                       params->memCopy ? "memcpy" : "none");
+        if (params->compressor[0] != '\0' && params->compressLevel == 0)
+                printf("\tcompressor         = %s, default level\n",
+                       params->compressor);
+        else if (params->compressor[0] != '\0')
+                printf("\tcompressor         = %s, level %d\n",
+                       params->compressor, params->compressLevel);
+        if (params->fillPipeline)
+                printf("\tfill pipeline      = %s on a helper thread\n",
+                       params->storeFileOffset ? "fill and verify" : "verify");
+        if (params->ciTarget > 0)
+                printf("\trepetitions        = %d to %d, until 95%% CI "
+                       "within %g%% of mean\n", params->minRepetitions,
+                       params->repetitions, params->ciTarget);
+        else
+                printf("\trepetitions        = %d\n", params->repetitions);
+        if (params->warmupRepetitions > 0)
+                printf("\twarm-up            = %d repetitions, not counted\n",
+                       params->warmupRepetitions);
+        if (params->cacheMode == cache_cold)
+                printf("\tcache              = cold, dropped before reads\n");
+        else if (params->cacheMode == cache_warm)
+                printf("\tcache              = warm, pre-read before reads\n");
+        else if (params->cacheMode == cache_direct)
+                printf("\tcache              = bypassed, O_DIRECT reads\n");
         printf("\txfersize           = %s\n",
                 HumanReadable(params->transferSize, BASE_TWO));
         printf("\tblocksize          = %s\n",
@@ -1643,14 +2691,17 @@ static void ShowSetup(IOR_param_t *params)
  */
 static void ShowTest(IOR_param_t * test)
 {
-        const char* data_packets[] = {"g", "t","o","i"};
+        const char* data_packets[] = {"g", "t","o","i","r"};
         
         fprintf(stdout, "TEST:\t%s=%d\n", "id", test->id);
         fprintf(stdout, "\t%s=%d\n", "refnum", test->referenceNumber);
         fprintf(stdout, "\t%s=%s\n", "api", test->api);
+        fprintf(stdout, "\t%s=%s\n", "apiLayers", test->apiLayers);
         fprintf(stdout, "\t%s=%s\n", "platform", test->platform);
         fprintf(stdout, "\t%s=%s\n", "testFileName", test->testFileName);
         fprintf(stdout, "\t%s=%s\n", "hintsFileName", test->hintsFileName);
+        fprintf(stdout, "\t%s=%s\n", "hintSearchFile", test->hintSearchFile);
+        fprintf(stdout, "\t%s=%s\n", "hintTuneFile", test->hintTuneFile);
         fprintf(stdout, "\t%s=%d\n", "deadlineForStonewall",
                 test->deadlineForStonewalling);
         fprintf(stdout, "\t%s=%d\n", "maxTimeDuration", test->maxTimeDuration);
@@ -1660,8 +2711,48 @@ static void ShowTest(IOR_param_t * test)
         fprintf(stdout, "\t%s=%d\n", "nodes", test->nodes);
         fprintf(stdout, "\t%s=%lu\n", "memoryPerTask", (unsigned long) test->memoryPerTask);
         fprintf(stdout, "\t%s=%lu\n", "memoryPerNode", (unsigned long) test->memoryPerNode);
+        fprintf(stdout, "\t%s=%lld\n", "hugePages", test->hugePages);
+        fprintf(stdout, "\t%s=%s\n", "bufferNuma", test->bufferNuma);
+        fprintf(stdout, "\t%s=%d\n", "lockBuffers", test->lockBuffers);
+        fprintf(stdout, "\t%s=%d\n", "bufferPool", test->bufferPool);
+        fprintf(stdout, "\t%s=%lld\n", "bufferBudget", test->bufferBudget);
+        fprintf(stdout, "\t%s=%d\n", "fillPipeline", test->fillPipeline);
+        fprintf(stdout, "\t%s=%g\n", "compressRatio", test->compressRatio);
+        fprintf(stdout, "\t%s=%g\n", "dedupRatio", test->dedupRatio);
+        fprintf(stdout, "\t%s=%lld\n", "dedupBlockSize", test->dedupBlockSize);
+        fprintf(stdout, "\t%s=%s\n", "compressor", test->compressor);
+        fprintf(stdout, "\t%s=%d\n", "compressLevel", test->compressLevel);
+        fprintf(stdout, "\t%s=%g\n", "delayLatency", test->delayLatency);
+        fprintf(stdout, "\t%s=%g\n", "delayJitter", test->delayJitter);
+        fprintf(stdout, "\t%s=%lld\n", "throttleBandwidth",
+                test->throttleBandwidth);
+        fprintf(stdout, "\t%s=%d\n", "memCopy", test->memCopy);
+        fprintf(stdout, "\t%s=%g\n", "paceRate", test->paceRate);
+        fprintf(stdout, "\t%s=%lld\n", "paceBandwidth", test->paceBandwidth);
+        fprintf(stdout, "\t%s=%d\n", "paceAggregate", test->paceAggregate);
+        fprintf(stdout, "\t%s=%d\n", "paceLoop", test->paceLoop);
+        fprintf(stdout, "\t%s=%lld\n", "burstSize", test->burstSize);
+        fprintf(stdout, "\t%s=%g\n", "computeTime", test->computeTime);
+        fprintf(stdout, "\t%s=%d\n", "computeBurn", test->computeBurn);
         fprintf(stdout, "\t%s=%d\n", "tasksPerNode", tasksPerNode);
+        fprintf(stdout, "\t%s=%d\n", "virtualRanks", test->virtualRanks);
+        fprintf(stdout, "\t%s=%d\n", "tasksPerFile", test->tasksPerFile);
+        fprintf(stdout, "\t%s=%d\n", "subarrayDims", test->subarrayDims);
+        fprintf(stdout, "\t%s=%dx%dx%d\n", "globalDims", test->globalDims[0],
+                test->globalDims[1], test->globalDims[2]);
+        fprintf(stdout, "\t%s=%dx%dx%d\n", "processGrid",
+                test->processGrid[0], test->processGrid[1],
+                test->processGrid[2]);
+        fprintf(stdout, "\t%s=%d\n", "elementSize", test->elementSize);
+        fprintf(stdout, "\t%s=%d\n", "writerTasks", test->writerTasks);
+        fprintf(stdout, "\t%s=%lld\n", "restartBlockSize",
+                test->restartBlockSize);
         fprintf(stdout, "\t%s=%d\n", "repetitions", test->repetitions);
+        fprintf(stdout, "\t%s=%g\n", "ciTarget", test->ciTarget);
+        fprintf(stdout, "\t%s=%d\n", "minRepetitions", test->minRepetitions);
+        fprintf(stdout, "\t%s=%d\n", "warmupRepetitions",
+                test->warmupRepetitions);
+        fprintf(stdout, "\t%s=%d\n", "cacheMode", test->cacheMode);
         fprintf(stdout, "\t%s=%d\n", "multiFile", test->multiFile);
         fprintf(stdout, "\t%s=%d\n", "interTestDelay", test->interTestDelay);
         fprintf(stdout, "\t%s=%d\n", "fsync", test->fsync);
@@ -1679,6 +2770,9 @@ static void ShowTest(IOR_param_t * test)
         fprintf(stdout, "\t%s=%d\n", "writeFile", test->writeFile);
         fprintf(stdout, "\t%s=%d\n", "filePerProc", test->filePerProc);
         fprintf(stdout, "\t%s=%d\n", "reorderTasks", test->reorderTasks);
+        fprintf(stdout, "\t%s=%d\n", "reorderTasksTopology",
+                test->reorderTasksTopology);
+        fprintf(stdout, "\t%s=%s\n", "topologyFile", test->topologyFile);
         fprintf(stdout, "\t%s=%d\n", "reorderTasksRandom",
                 test->reorderTasksRandom);
         fprintf(stdout, "\t%s=%d\n", "reorderTasksRandomSeed",
@@ -1695,6 +2789,9 @@ static void ShowTest(IOR_param_t * test)
         fprintf(stdout, "\t%s=%d\n", "useO_DIRECT", test->useO_DIRECT);
         fprintf(stdout, "\t%s=%d\n", "useStridedDatatype",
                 test->useStridedDatatype);
+        fprintf(stdout, "\t%s=%d\n", "nonblockingWindow",
+                test->nonblockingWindow);
+        fprintf(stdout, "\t%s=%d\n", "randomBatch", test->randomBatch);
         fprintf(stdout, "\t%s=%d\n", "keepFile", test->keepFile);
         fprintf(stdout, "\t%s=%d\n", "keepFileWithError",
                 test->keepFileWithError);
@@ -1704,6 +2801,14 @@ static void ShowTest(IOR_param_t * test)
         fprintf(stdout, "\t%s=%d\n", "setTimeStampSignature/incompressibleSeed",
                 test->setTimeStampSignature); /* Seed value was copied into setTimeStampSignature as well */
         fprintf(stdout, "\t%s=%d\n", "collective", test->collective);
+        fprintf(stdout, "\t%s=%d\n", "twoPhase", test->twoPhase);
+        fprintf(stdout, "\t%s=%d\n", "twoPhaseAggregators",
+                test->twoPhaseAggregators);
+        fprintf(stdout, "\t%s=%lld\n", "twoPhaseBufferSize",
+                test->twoPhaseBufferSize);
+        fprintf(stdout, "\t%s=%d\n", "workStealing", test->workStealing);
+        fprintf(stdout, "\t%s=%d\n", "workStealingPerNode",
+                test->workStealingPerNode);
         fprintf(stdout, "\t%s=%lld", "segmentCount", test->segmentCount);
 #ifdef HAVE_GPFS_FCNTL_H
         fprintf(stdout, "\t%s=%d\n", "gpfsHintAccess", test->gpfs_hint_access);
@@ -1736,16 +2841,46 @@ struct results {
         double var;
         double sd;
         double sum;
+        double median;
+        double cov;                     /* coefficient of variation, % */
+        double ci;                      /* 95% CI half-width, % of mean */
         double *val;
 };
 
+/*
+ * Two-sided 95% quantile of Student's t distribution with 'df' degrees of
+ * freedom.
+ */
+static double StudentT95(int df)
+{
+        static const double t[] = {
+                12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+        };
+
+        if (df < 1)
+                return 0.0;
+        if (df <= 30)
+                return t[df - 1];
+        return (df <= 60 ? 2.000 : (df <= 120 ? 1.980 : 1.960));
+}
+
+static int CompareDoubles(const void *a, const void *b)
+{
+        double x = *(const double *)a, y = *(const double *)b;
+
+        return (x > y) - (x < y);
+}
+
 static struct results *bw_values(int reps, IOR_offset_t *agg_file_size, double *vals)
 {
         struct results *r;
         int i;
 
         r = (struct results *)malloc(sizeof(struct results)
-                                     + (reps * sizeof(double)));
+                                     + (2 * reps * sizeof(double)));
         if (r == NULL)
                 ERR("malloc failed");
         r->val = (double *)&r[1];
@@ -1769,9 +2904,60 @@ static struct results *bw_values(int reps, IOR_offset_t *agg_file_size, double *
         r->var = r->var / reps;
         r->sd = sqrt(r->var);
 
+        /* median from a sorted copy, after the values */
+        memcpy(&r->val[reps], r->val, reps * sizeof(double));
+        qsort(&r->val[reps], reps, sizeof(double), CompareDoubles);
+        r->median = reps % 2 ? r->val[reps + reps / 2]
+                : (r->val[reps + reps / 2 - 1] + r->val[reps + reps / 2]) / 2;
+        r->cov = r->mean > 0 ? 100.0 * r->sd / r->mean : 0.0;
+        /* the CI uses the sample standard deviation; -1 if undefined */
+        r->ci = -1.0;
+        if (reps > 1 && r->mean > 0)
+                r->ci = 100.0 * StudentT95(reps - 1) * r->sd
+                        * sqrt((double)reps / (reps - 1)) / sqrt(reps)
+                        / r->mean;
+
         return r;
 }
 
+/*
+ * Whether the first 'reps' repetitions of an adaptive test have narrowed the
+ * 95% confidence interval of each phase's mean bandwidth to the ciTarget.
+ */
+static int RepetitionsConverged(IOR_test_t *test, int reps)
+{
+        IOR_param_t *params = &test->params;
+        struct results *bw;
+        double worst = 0.0;
+        int converged = TRUE;
+
+        if (reps < params->minRepetitions)
+                return FALSE;
+
+        if (rank == 0) {
+                if (params->writeFile) {
+                        bw = bw_values(reps, test->results->aggFileSizeForBW,
+                                       test->results->writeTime);
+                        worst = bw->ci;
+                        free(bw);
+                }
+                if (params->readFile && worst >= 0) {
+                        bw = bw_values(reps, test->results->aggFileSizeForBW,
+                                       test->results->readTime);
+                        worst = bw->ci < 0 ? bw->ci : MAX(worst, bw->ci);
+                        free(bw);
+                }
+                converged = worst >= 0 && worst <= params->ciTarget;
+                if (verbose >= VERBOSE_1)
+                        fprintf(stdout, "after %d repetitions, 95%% CI is "
+                                "within %.2f%% of mean bandwidth%s\n", reps,
+                                worst, converged ? ", stopping" : "");
+        }
+        MPI_CHECK(MPI_Bcast(&converged, 1, MPI_INT, 0, testComm),
+                  "cannot broadcast convergence");
+        return converged;
+}
+
 /*
  * Summarize results
  *
@@ -1799,8 +2985,8 @@ static void PrintLongSummaryOneOperation(IOR_test_t *test, double *times, char *
         fprintf(stdout, "%10.5f ",
                 mean_of_array_of_doubles(times, reps));
         fprintf(stdout, "%d ", params->id);
-        fprintf(stdout, "%d ", params->numTasks);
-        fprintf(stdout, "%d ", params->tasksPerNode);
+        fprintf(stdout, "%d ", params->numTasks * params->virtualRanks);
+        fprintf(stdout, "%d ", params->tasksPerNode * params->virtualRanks);
         fprintf(stdout, "%d ", params->repetitions);
         fprintf(stdout, "%d ", params->filePerProc);
         fprintf(stdout, "%d ", params->reorderTasks);
@@ -1812,7 +2998,14 @@ static void PrintLongSummaryOneOperation(IOR_test_t *test, double *times, char *
         fprintf(stdout, "%lld ", params->transferSize);
         fprintf(stdout, "%lld ", results->aggFileSizeForBW[0]);
         fprintf(stdout, "%s ", params->api);
-        fprintf(stdout, "%d", params->referenceNumber);
+        fprintf(stdout, "%d ", params->referenceNumber);
+        /* added columns go last to keep the positions scripts parse */
+        fprintf(stdout, "%.2f ", bw->median / MEBIBYTE);
+        fprintf(stdout, "%.2f ", bw->cov);
+        if (bw->ci < 0)
+                fprintf(stdout, "-");
+        else
+                fprintf(stdout, "%.2f", bw->ci);
         fprintf(stdout, "\n");
         fflush(stdout);
 
@@ -1840,7 +3033,8 @@ static void PrintLongSummaryHeader()
                 "Operation", "Max(MiB)", "Min(MiB)", "Mean(MiB)", "StdDev",
                 "Mean(s)");
         fprintf(stdout, " Test# #Tasks tPN reps fPP reord reordoff reordrand seed"
-                " segcnt blksiz xsize aggsize API RefNum\n");
+                " segcnt blksiz xsize aggsize API RefNum"
+                " Median(MiB) CoV(%%) CI95(%%)\n");
 }
 
 static void PrintLongSummaryAllTests(IOR_test_t *tests_head)
@@ -1859,6 +3053,96 @@ static void PrintLongSummaryAllTests(IOR_test_t *tests_head)
         }
 }
 
+/*
+ * Print the median and 99th percentile latency of a paced test's phase.
+ */
+static void PrintSweepLatency(long long *hist, double max)
+{
+        long long ops = 0;
+        int i;
+
+        for (i = 0; i < PACE_BUCKETS; i++)
+                ops += hist[i];
+        if (ops == 0)
+                fprintf(stdout, " %10s %10s", "-", "-");
+        else
+                fprintf(stdout, " %10.1f %10.1f",
+                        1.0e6 * PaceQuantile(hist, 0.5, max),
+                        1.0e6 * PaceQuantile(hist, 0.99, max));
+}
+
+/*
+ * Print each script sweep as a matrix: a row per combination of the swept
+ * options, with the mean write and read bandwidth, and for paced tests the
+ * latency of the write and read transfers over all repetitions.  Sweeping
+ * the offered rate gives the latency against load.
+ */
+static void PrintSweepMatrix(IOR_test_t *tests_head)
+{
+        IOR_test_t *tptr, *first;
+        char label[MAX_STR], *setting, *value;
+        double writeBW, readBW;
+        int paced;
+
+        if (rank != 0 || verbose < VERBOSE_0)
+                return;
+
+        for (first = tests_head; first != NULL; first = first->next) {
+                if (first->params.sweepId == 0)
+                        continue;
+                /* print each sweep once, from its first test */
+                for (tptr = tests_head; tptr != first; tptr = tptr->next)
+                        if (tptr->params.sweepId == first->params.sweepId)
+                                break;
+                if (tptr != first)
+                        continue;
+
+                paced = FALSE;
+                for (tptr = first; tptr != NULL; tptr = tptr->next)
+                        if (tptr->params.sweepId == first->params.sweepId
+                            && (tptr->params.paceRate > 0
+                                || tptr->params.paceBandwidth > 0))
+                                paced = TRUE;
+
+                fprintf(stdout, "\nSweep %d:\n", first->params.sweepId);
+                strcpy(label, first->params.sweepLabel);
+                for (setting = strtok(label, " "); setting != NULL;
+                     setting = strtok(NULL, " ")) {
+                        setting[strcspn(setting, "=")] = '\0';
+                        fprintf(stdout, "%-16s ", setting);
+                }
+                fprintf(stdout, "%10s %10s", "Write", "Read");
+                if (paced)
+                        fprintf(stdout, " %10s %10s %10s %10s", "W p50(us)",
+                                "W p99(us)", "R p50(us)", "R p99(us)");
+                fprintf(stdout, "\n");
+                for (tptr = first; tptr != NULL; tptr = tptr->next) {
+                        if (tptr->params.sweepId != first->params.sweepId)
+                                continue;
+                        strcpy(label, tptr->params.sweepLabel);
+                        for (setting = strtok(label, " "); setting != NULL;
+                             setting = strtok(NULL, " ")) {
+                                value = strchr(setting, '=');
+                                fprintf(stdout, "%-16s ",
+                                        value != NULL ? value + 1 : setting);
+                        }
+                        TestBandwidth(tptr, &writeBW, &readBW);
+                        fprintf(stdout, "%10.2f %10.2f",
+                                writeBW / MEBIBYTE, readBW / MEBIBYTE);
+                        if (paced) {
+                                PrintSweepLatency(tptr->results->paceHist,
+                                                  tptr->results->paceMax[0]);
+                                PrintSweepLatency(tptr->results->paceHist
+                                                  + PACE_BUCKETS,
+                                                  tptr->results->paceMax[1]);
+                        }
+                        fprintf(stdout, "\n");
+                }
+                fprintf(stdout, "(MiB/s, mean over repetitions)\n");
+        }
+        fflush(stdout);
+}
+
 static void PrintShortSummary(IOR_test_t * test)
 {
         IOR_param_t *params = &test->params;
@@ -1976,6 +3260,140 @@ int test_time_elapsed(IOR_param_t *params, double startTime)
         return GetTimeStamp() >= endTime;
 }
 
+/*
+ * Bursty writes.  A write phase moves burstSize per task at a time, all
+ * tasks together, then computes for computeTime, as an application writing
+ * checkpoints does.  Task 0 samples the dirty and writeback page cache of
+ * its node through each gap, to see how fast the storage drains a burst.
+ */
+static struct {
+        void *hog;                      /* memoryPerTask/Node, to burn */
+        size_t hogSize;
+        size_t cursor;                  /* where the burner is in it */
+        int count;                      /* bursts so far in the phase */
+        int bursts;                     /* in the phase */
+        double start;                   /* of the current burst */
+        IOR_offset_t bytes;             /* moved in the current burst */
+        long long baseline;             /* dirty bytes before the phase */
+} burst;
+
+/*
+ * Bytes of dirty and writeback page cache on this node, or -1 if unknown.
+ */
+static long long DirtyBytes(void)
+{
+        char line[MAX_STR];
+        long long kB, total = -1;
+        FILE *meminfo = fopen("/proc/meminfo", "r");
+
+        if (meminfo == NULL)
+                return (-1);
+        while (fgets(line, sizeof(line), meminfo) != NULL) {
+                if (sscanf(line, "Dirty: %lld kB", &kB) == 1
+                    || sscanf(line, "Writeback: %lld kB", &kB) == 1)
+                        total = (total < 0 ? 0 : total) + 1024 * kB;
+        }
+        fclose(meminfo);
+        return (total);
+}
+
+/*
+ * Read and write the next MiB of the hog memory, wrapping around.
+ */
+static void BurnMemory(void)
+{
+        unsigned long *word = (unsigned long *)((char *)burst.hog
+                                                + burst.cursor);
+        size_t i, n = burst.hogSize - burst.cursor;
+
+        if (n > MEBIBYTE)
+                n = MEBIBYTE;
+        for (i = 0; i < n / sizeof(unsigned long); i++)
+                word[i] += i;
+        burst.cursor += n;
+        if (burst.cursor >= burst.hogSize)
+                burst.cursor = 0;
+}
+
+static void BurstStart(IOR_param_t *test)
+{
+        IOR_offset_t transfers = test->blockSize / test->transferSize
+                                 * test->segmentCount * test->virtualRanks;
+        IOR_offset_t perBurst = test->burstSize / test->transferSize;
+
+        burst.count = 0;
+        burst.bursts = (transfers + perBurst - 1) / perBurst;
+        if (rank == 0)
+                burst.baseline = DirtyBytes();
+}
+
+static void BurstBegin(void)
+{
+        MPI_CHECK(MPI_Barrier(testComm), "barrier error");
+        burst.start = MPI_Wtime();
+        burst.bytes = 0;
+}
+
+/*
+ * End a burst and compute through the gap after it, then report the burst's
+ * bandwidth over all tasks and how much of the dirty data it left the node
+ * of task 0 drained in the gap.
+ */
+static void BurstEnd(IOR_param_t *test)
+{
+        double local = MPI_Wtime() - burst.start, elapsed;
+        double gapStart, gapEnd, now, drained = -1;
+        IOR_offset_t bytes;
+        long long peak = -1, left = -1, target = 0;
+
+        MPI_CHECK(MPI_Reduce(&local, &elapsed, 1, MPI_DOUBLE, MPI_MAX, 0,
+                             testComm), "cannot reduce burst times");
+        MPI_CHECK(MPI_Reduce(&burst.bytes, &bytes, 1, MPI_LONG_LONG_INT,
+                             MPI_SUM, 0, testComm),
+                  "cannot reduce burst bytes");
+        burst.count++;
+
+        /* the reduce has waited for every task's burst */
+        if (rank == 0 && burst.baseline >= 0) {
+                peak = left = DirtyBytes();
+                target = burst.baseline + (peak - burst.baseline) / 10;
+        }
+        gapStart = MPI_Wtime();
+        gapEnd = gapStart + test->computeTime;
+        while ((now = MPI_Wtime()) < gapEnd) {
+                if (test->computeBurn)
+                        BurnMemory();
+                else if (peak >= 0 && gapEnd - now > 0.01)
+                        SleepFor(0.01);
+                else
+                        SleepFor(gapEnd - now);
+                if (peak >= 0) {
+                        left = DirtyBytes();
+                        if (drained < 0 && left <= target)
+                                drained = MPI_Wtime() - gapStart;
+                }
+        }
+        if (rank != 0 || verbose < VERBOSE_0)
+                return;
+
+        fprintf(stdout, "burst:    %d/%d %.2f MiB in %.6f s, %.2f MiB/s",
+                burst.count, burst.bursts, (double)bytes / MEBIBYTE, elapsed,
+                elapsed > 0 ? (double)bytes / MEBIBYTE / elapsed : 0.0);
+        if (peak >= 0 && test->computeTime > 0) {
+                fprintf(stdout, "; dirty %.2f MiB", (double)peak / MEBIBYTE);
+                if (peak - burst.baseline < MEBIBYTE)
+                        fprintf(stdout, ", nothing to drain");
+                else if (drained >= 0)
+                        fprintf(stdout, ", 90%% drained in %.3f s",
+                                drained);
+                else
+                        fprintf(stdout, ", %.2f MiB left after %g s",
+                                (double)left / MEBIBYTE, test->computeTime);
+        }
+        fprintf(stdout, "\n");
+        fflush(stdout);
+}
+
 /*
  * hog some memory as a rough simulation of a real application's memory use
  */
@@ -2001,6 +3419,8 @@ static void *HogMemory(IOR_param_t *params)
         buf = malloc_and_touch(size);
         if (buf == NULL)
                 ERR("malloc of simulated applciation buffer failed");
+        burst.hog = buf;
+        burst.hogSize = size;
 
         return buf;
 }
@@ -2014,10 +3434,11 @@ static void TestIoSys(IOR_test_t *test)
         IOR_results_t *results = test->results;
         char testFileName[MAX_STR];
         double *timer[12];
-        double startTime;
+        double startTime, checkStart;
         int pretendRank;
-        int i, rep;
+        int i, rep, warmup, directWrite;
         void *fd;
+        ior_aiori_t *layer;
         MPI_Group orig_group, new_group;
         int range[3];
         IOR_offset_t dataMoved; /* for data rate calculation */
@@ -2035,17 +3456,29 @@ static void TestIoSys(IOR_test_t *test)
                 }
                 params->numTasks = numTasksWorld;
         }
-        MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &orig_group),
-                  "MPI_Comm_group() error");
-        range[0] = 0;                     /* first rank */
-        range[1] = params->numTasks - 1;  /* last rank */
-        range[2] = 1;                     /* stride */
-        MPI_CHECK(MPI_Group_range_incl(orig_group, 1, &range, &new_group),
-                  "MPI_Group_range_incl() error");
-        MPI_CHECK(MPI_Comm_create(MPI_COMM_WORLD, new_group, &testComm),
-                  "MPI_Comm_create() error");
-        MPI_CHECK(MPI_Group_free(&orig_group), "MPI_Group_Free() error");
-        MPI_CHECK(MPI_Group_free(&new_group), "MPI_Group_Free() error");
+        /* reuse the previous test's communicator when the task count is
+           unchanged, as in a sweep */
+        if (params->numTasks != testCommTasks) {
+                TestCommFree();
+                MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &orig_group),
+                          "MPI_Comm_group() error");
+                range[0] = 0;                     /* first rank */
+                range[1] = params->numTasks - 1;  /* last rank */
+                range[2] = 1;                     /* stride */
+                MPI_CHECK(MPI_Group_range_incl(orig_group, 1, &range,
+                                               &new_group),
+                          "MPI_Group_range_incl() error");
+                MPI_CHECK(MPI_Comm_create(MPI_COMM_WORLD, new_group,
+                                          &testComm),
+                          "MPI_Comm_create() error");
+                MPI_CHECK(MPI_Group_free(&orig_group),
+                          "MPI_Group_Free() error");
+                MPI_CHECK(MPI_Group_free(&new_group),
+                          "MPI_Group_Free() error");
+                testCommTasks = params->numTasks;
+                testCommTasksPerNode = testComm == MPI_COMM_NULL ? 0 :
+                        CountTasksPerNode(params->numTasks, testComm);
+        }
         params->testComm = testComm;
         if (testComm == MPI_COMM_NULL) {
                 /* tasks not in the group do not participate in this test */
@@ -2061,7 +3494,9 @@ static void TestIoSys(IOR_test_t *test)
                         "Using reorderTasks '-C' (expecting block, not cyclic, task assignment)\n");
                 fflush(stdout);
         }
-        params->tasksPerNode = CountTasksPerNode(params->numTasks, testComm);
+        params->tasksPerNode = testCommTasksPerNode;
+        if (params->reorderTasksTopology)
+                TopologyReorder(params);
 
         /* setup timers */
         for (i = 0; i < 12; i++) {
@@ -2076,6 +3511,9 @@ static void TestIoSys(IOR_test_t *test)
         /* show test setup */
         if (rank == 0 && verbose >= VERBOSE_0)
                 ShowSetup(params);
+        if (rank == 0 && verbose >= VERBOSE_1
+            && params->dataPacketType == tunable)
+                DataRatioEstimate(params);
 
         hog_buf = HogMemory(params);
 
@@ -2085,16 +3523,33 @@ static void TestIoSys(IOR_test_t *test)
 
         XferBuffersSetup(&ioBuffers, params, pretendRank);
 
+        if (params->virtualRanks > 1) {
+                virtualFd = (void **)malloc(params->virtualRanks
+                                            * sizeof(void *));
+                if (virtualFd == NULL)
+                        ERR("malloc failed");
+        }
+
+        if (params->workStealing)
+                WorkQueueSetup(params);
+
         /* Initial time stamp */
         startTime = GetTimeStamp();
 
-        /* loop over test iterations */
-        for (rep = 0; rep < params->repetitions; rep++) {
+        /* loop over test iterations, after the uncounted warm-up ones,
+           which reuse the slot of the first */
+        warmup = params->warmupRepetitions;
+        for (rep = 0; rep < params->repetitions;) {
+                warmingUp = warmup > 0;
 
                 /* Get iteration start time in seconds in task 0 and broadcast to
                    all tasks */
                 if (rank == 0) {
-                        if (params->dataPacketType == timestamp && params->setTimeStampSignature) {
+                        /* restart tests need the writers' signature to verify */
+                        if ((params->dataPacketType == timestamp
+                             || params->dataPacketType == tunable
+                             || params->writerTasks > 0)
+                            && params->setTimeStampSignature) {
                                 params->timeStampSignatureValue =
                                         (unsigned int)params->setTimeStampSignature;
                         } else {
@@ -2111,7 +3566,8 @@ static void TestIoSys(IOR_test_t *test)
                                         params->timeStampSignatureValue,
                                         params->timeStampSignatureValue);
                         }
-                        if (rep == 0 && verbose >= VERBOSE_0) {
+                        if (rep == 0 && warmup == params->warmupRepetitions
+                            && verbose >= VERBOSE_0) {
                                 fprintf(stdout, "\n");
                                 fprintf(stdout, "access    bw(MiB/s)  block(KiB) xfer(KiB)  open(s)    wr/rd(s)   close(s)   total(s)   iter\n");
                                 fprintf(stdout, "------    ---------  ---------- ---------  --------   --------   --------   --------   ----\n");
@@ -2120,6 +3576,9 @@ static void TestIoSys(IOR_test_t *test)
                 MPI_CHECK(MPI_Bcast
                           (&params->timeStampSignatureValue, 1, MPI_UNSIGNED, 0,
                            testComm), "cannot broadcast start time value");
+                /* the data written carries this repetition's signature */
+                if (params->writeFile && params->dataPacketType != incompressible)
+                        XferBuffersFill(&ioBuffers, params, pretendRank);
                 /* use repetition count for number of multiple files */
                 if (params->multiFile)
                         params->repCounter = rep;
@@ -2130,19 +3589,19 @@ static void TestIoSys(IOR_test_t *test)
 
                 if (params->writeFile && !test_time_elapsed(params, startTime)) {
                         GetTestFileName(testFileName, params);
+                        SetupFileComm(params);
                         if (verbose >= VERBOSE_3) {
                                 fprintf(stdout, "task %d writing %s\n", rank,
                                         testFileName);
                         }
                         DelaySecs(params->interTestDelay);
                         if (params->useExistingTestFile == FALSE) {
-                                RemoveFile(testFileName, params->filePerProc,
-                                           params);
+                                RemoveTestFiles(testFileName, params);
                         }
                         MPI_CHECK(MPI_Barrier(testComm), "barrier error");
                         params->open = WRITE;
                         timer[0][rep] = GetTimeStamp();
-                        fd = backend->create(testFileName, params);
+                        fd = OpenTestFiles(testFileName, params, TRUE);
                         timer[1][rep] = GetTimeStamp();
                         if (params->intraTestBarriers)
                                 MPI_CHECK(MPI_Barrier(testComm),
@@ -2163,14 +3622,14 @@ static void TestIoSys(IOR_test_t *test)
                                 MPI_CHECK(MPI_Barrier(testComm),
                                           "barrier error");
                         timer[4][rep] = GetTimeStamp();
-                        backend->close(fd, params);
+                        CloseTestFiles(fd, params);
 
                         timer[5][rep] = GetTimeStamp();
                         MPI_CHECK(MPI_Barrier(testComm), "barrier error");
 
                         /* get the size of the file just written */
                         results->aggFileSizeFromStat[rep] =
-                                backend->get_file_size(params, testComm, testFileName);
+                                GetTestFilesSize(testFileName, params);
 
                         /* check if stat() of file doesn't equal expected file size,
                            use actual amount of byte moved */
@@ -2179,6 +3638,28 @@ static void TestIoSys(IOR_test_t *test)
                         if (verbose >= VERBOSE_3)
                                 WriteTimes(params, timer, rep, WRITE);
                         ReduceIterResults(test, timer, rep, WRITE);
+                        if (params->workStealing)
+                                WorkQueuePrintShare(params,
+                                                    timer[3][rep] - timer[2][rep],
+                                                    WRITE);
+                        if (params->useSharedFilePointer)
+                                SharedPointerPrintCost(params, testFileName,
+                                                       timer[3][rep] - timer[2][rep],
+                                                       WRITE);
+                        if (params->fillPipeline)
+                                PipelinePrintBlocked(timer[3][rep] - timer[2][rep],
+                                                     WRITE);
+                        if (params->compressor[0] != '\0')
+                                CompressPrintStats(timer[3][rep] - timer[2][rep],
+                                                   WRITE);
+                        if (strcmp(params->api, "MEM") == 0)
+                                MemPrintOps(params,
+                                            timer[3][rep] - timer[2][rep],
+                                            WRITE);
+                        if (params->paceRate > 0 || params->paceBandwidth > 0)
+                                PacePrint(test,
+                                          timer[3][rep] - timer[2][rep],
+                                          WRITE);
                         if (params->outlierThreshold) {
                                 CheckForOutliers(params, timer, rep, WRITE);
                         }
@@ -2200,14 +3681,21 @@ static void TestIoSys(IOR_test_t *test)
                                 rankOffset =
                                         (2 * params->tasksPerNode) % params->numTasks;
                         }
+                        if (params->reorderTasksTopology)
+                                rankOffset = topologyOffset;
 
                         reseed_incompressible_prng = TRUE; /* Re-Seed the PRNG to get same sequence back, if random */
 
                         GetTestFileName(testFileName, params);
+                        SetupFileComm(params);
                         params->open = WRITECHECK;
-                        fd = backend->open(testFileName, params);
+                        fd = OpenTestFiles(testFileName, params, FALSE);
+                        checkStart = GetTimeStamp();
                         dataMoved = WriteOrRead(params, fd, WRITECHECK, &ioBuffers);
-                        backend->close(fd, params);
+                        if (params->fillPipeline)
+                                PipelinePrintBlocked(GetTimeStamp() - checkStart,
+                                                     WRITECHECK);
+                        CloseTestFiles(fd, params);
                         rankOffset = 0;
                 }
                 /*
@@ -2216,6 +3704,8 @@ static void TestIoSys(IOR_test_t *test)
                 if (params->readFile && !test_time_elapsed(params, startTime)) {
                         /* Get rankOffset [file offset] for this process to read, based on -C,-Z,-Q,-X options */
                         /* Constant process offset reading */
+                        if (params->reorderTasksTopology)
+                                rankOffset = topologyOffset;
                         if (params->reorderTasks) {
                                 /* move taskPerNodeOffset nodes[1==default] away from writing node */
                                 rankOffset =
@@ -2249,17 +3739,31 @@ static void TestIoSys(IOR_test_t *test)
                         }
                         /* Using globally passed rankOffset, following function generates testFileName to read */
                         GetTestFileName(testFileName, params);
+                        SetupFileComm(params);
 
                         if (verbose >= VERBOSE_3) {
                                 fprintf(stdout, "task %d reading %s\n", rank,
                                         testFileName);
                         }
                         DelaySecs(params->interTestDelay);
+                        if (params->cacheMode != cache_any) {
+                                MPI_CHECK(MPI_Barrier(testComm),
+                                          "barrier error");
+                                SetCacheState(testFileName, params);
+                        }
                         MPI_CHECK(MPI_Barrier(testComm), "barrier error");
                         params->open = READ;
+                        /* the direct cache mode re-opens for reads only */
+                        directWrite = params->useO_DIRECT;
+                        if (params->cacheMode == cache_direct)
+                                params->useO_DIRECT = TRUE;
                         timer[6][rep] = GetTimeStamp();
-                        fd = backend->open(testFileName, params);
+                        fd = OpenTestFiles(testFileName, params, FALSE);
                         timer[7][rep] = GetTimeStamp();
+                        params->useO_DIRECT = directWrite;
+                        if (params->cacheMode == cache_direct
+                            && !has_o_direct_flag(*(int *)fd))
+                                ERR("test file not opened with O_DIRECT");
                         if (params->intraTestBarriers)
                                 MPI_CHECK(MPI_Barrier(testComm),
                                           "barrier error");
@@ -2275,13 +3779,12 @@ static void TestIoSys(IOR_test_t *test)
                                 MPI_CHECK(MPI_Barrier(testComm),
                                           "barrier error");
                         timer[10][rep] = GetTimeStamp();
-                        backend->close(fd, params);
+                        CloseTestFiles(fd, params);
                         timer[11][rep] = GetTimeStamp();
 
                         /* get the size of the file just read */
                         results->aggFileSizeFromStat[rep] =
-                                backend->get_file_size(params, testComm,
-                                                       testFileName);
+                                GetTestFilesSize(testFileName, params);
 
                         /* check if stat() of file doesn't equal expected file size,
                            use actual amount of byte moved */
@@ -2290,6 +3793,25 @@ static void TestIoSys(IOR_test_t *test)
                         if (verbose >= VERBOSE_3)
                                 WriteTimes(params, timer, rep, READ);
                         ReduceIterResults(test, timer, rep, READ);
+                        if (params->workStealing)
+                                WorkQueuePrintShare(params,
+                                                    timer[9][rep] - timer[8][rep],
+                                                    READ);
+                        if (params->useSharedFilePointer)
+                                SharedPointerPrintCost(params, testFileName,
+                                                       timer[9][rep] - timer[8][rep],
+                                                       READ);
+                        if (params->compressor[0] != '\0')
+                                CompressPrintStats(timer[9][rep] - timer[8][rep],
+                                                   READ);
+                        if (strcmp(params->api, "MEM") == 0)
+                                MemPrintOps(params,
+                                            timer[9][rep] - timer[8][rep],
+                                            READ);
+                        if (params->paceRate > 0 || params->paceBandwidth > 0)
+                                PacePrint(test,
+                                          timer[9][rep] - timer[8][rep],
+                                          READ);
                         if (params->outlierThreshold) {
                                 CheckForOutliers(params, timer, rep, READ);
                         }
@@ -2311,7 +3833,10 @@ static void TestIoSys(IOR_test_t *test)
                                 /* move three nodes away from reading node */
                                 rankOffset = (3 * params->tasksPerNode) % params->numTasks;
                         }
+                        if (params->reorderTasksTopology)
+                                rankOffset = topologyOffset;
                         GetTestFileName(testFileName, params);
+                        SetupFileComm(params);
                         MPI_CHECK(MPI_Barrier(testComm), "barrier error");
                         params->open = READCHECK;
                         fd = backend->open(testFileName, params);
@@ -2339,7 +3864,7 @@ static void TestIoSys(IOR_test_t *test)
                         double start, finish;
                         start = GetTimeStamp();
                         MPI_CHECK(MPI_Barrier(testComm), "barrier error");
-                        RemoveFile(testFileName, params->filePerProc, params);
+                        RemoveTestFiles(testFileName, params);
                         MPI_CHECK(MPI_Barrier(testComm), "barrier error");
                         finish = GetTimeStamp();
                         PrintRemoveTiming(start, finish, rep);
@@ -2348,9 +3873,25 @@ static void TestIoSys(IOR_test_t *test)
                 }
                 params->errorFound = FALSE;
                 rankOffset = 0;
+
+                if (warmup > 0) {
+                        warmup--;
+                        continue;
+                }
+                rep++;
+                if (params->ciTarget > 0 && RepetitionsConverged(test, rep)) {
+                        /* the summaries cover the repetitions run */
+                        params->repetitions = rep;
+                        break;
+                }
         }
+        warmingUp = FALSE;
 
-        MPI_CHECK(MPI_Comm_free(&testComm), "MPI_Comm_free() error");
+        if (params->workStealing)
+                WorkQueueFree();
+        if (fileComm != MPI_COMM_NULL && fileComm != testComm)
+                MPI_CHECK(MPI_Comm_free(&fileComm), "MPI_Comm_free() error");
+        fileComm = MPI_COMM_NULL;
 
         if (params->summary_every_test) {
                 PrintLongSummaryHeader();
@@ -2359,10 +3900,20 @@ static void TestIoSys(IOR_test_t *test)
                 PrintShortSummary(test);
         }
 
-        XferBuffersFree(&ioBuffers, params);
+        for (layer = backend; layer != NULL; layer = layer->next)
+                if (layer == &stats_aiori)
+                        STATS_Report();
+
+        XferBuffersFree(&ioBuffers);
+
+        if (virtualFd != NULL) {
+                free(virtualFd);
+                virtualFd = NULL;
+        }
 
         if (hog_buf != NULL)
                 free(hog_buf);
+        burst.hog = NULL;
         for (i = 0; i < 12; i++) {
                 free(timer[i]);
         }
@@ -2372,6 +3923,247 @@ static void TestIoSys(IOR_test_t *test)
 
 }
 
+#define MAX_TUNE_HINTS      16          /* hints in a search space */
+#define MAX_TUNE_CANDIDATES 4096        /* hint combinations */
+
+/*
+ * Mean bandwidth of a test over its write and read phases, valid on rank 0.
+ */
+static double TestBandwidth(IOR_test_t *test, double *writeBW, double *readBW)
+{
+        IOR_param_t *params = &test->params;
+        struct results *bw;
+        double sum = 0.0;
+        int ops = 0;
+
+        *writeBW = *readBW = 0.0;
+        if (params->writeFile) {
+                bw = bw_values(params->repetitions,
+                               test->results->aggFileSizeForBW,
+                               test->results->writeTime);
+                *writeBW = bw->mean;
+                sum += bw->mean;
+                ops++;
+                free(bw);
+        }
+        if (params->readFile) {
+                bw = bw_values(params->repetitions,
+                               test->results->aggFileSizeForBW,
+                               test->results->readTime);
+                *readBW = bw->mean;
+                sum += bw->mean;
+                ops++;
+                free(bw);
+        }
+        return (ops > 0 ? sum / ops : 0.0);
+}
+
+/*
+ * Set (or, with 'candidate' < 0, restore) the hint environment for one
+ * combination of the search space; SetHints() picks the hints up from the
+ * environment at each open.
+ */
+static void SetTuneHints(char keys[][MAX_STR], char ***values, int *counts,
+                         int nKeys, int candidate, char saved[][MAX_STR])
+{
+        int k;
+
+        for (k = 0; k < nKeys; k++) {
+                if (candidate < 0) {
+                        if (saved[k][0] != '\0')
+                                setenv(keys[k], saved[k], 1);
+                        else
+                                unsetenv(keys[k]);
+                        continue;
+                }
+                setenv(keys[k], values[k][candidate % counts[k]], 1);
+                candidate /= counts[k];
+        }
+}
+
+/*
+ * Tune MPI-IO hints by successive halving.  Every combination of the hint
+ * values in hintSearchFile (lines of 'IOR_HINT__<layer>__<hint>=<sweep>',
+ * see ExpandSweep()) runs as a short trial of the test; the better half is
+ * kept and rerun with twice the repetitions until one remains.  The result
+ * table is printed, the winning hints are written to hintTuneFile, and the
+ * test is then run in full with them.
+ */
+static void TuneHints(IOR_test_t *test)
+{
+        IOR_param_t *params = &test->params;
+        char keys[MAX_TUNE_HINTS][MAX_STR], saved[MAX_TUNE_HINTS][MAX_STR];
+        char line[MAX_STR], tuneFile[MAXPATHLEN];
+        char **values[MAX_TUNE_HINTS];
+        int counts[MAX_TUNE_HINTS];
+        int nKeys = 0, nCandidates = 1, nAlive, round = 0, reps;
+        int *alive, *order, *lastRound, *lastReps;
+        double *score, *writeBW, *readBW;
+        int savedVerbose = verbose;
+        int i, j, k;
+        char *value;
+        FILE *file;
+
+        /* read the search space */
+        file = fopen(params->hintSearchFile, "r");
+        if (file == NULL)
+                ERR("cannot open hint search file");
+        while (fgets(line, MAX_STR, file) != NULL) {
+                if (strncmp(line, "IOR_HINT", strlen("IOR_HINT")) != 0)
+                        continue;
+                value = strchr(line, '=');
+                if (value == NULL)
+                        ERR("hint search line needs '=<values>'");
+                if (nKeys == MAX_TUNE_HINTS)
+                        ERR("too many hints in search file");
+                *value++ = '\0';
+                value[strcspn(value, "\r\n")] = '\0';
+                strcpy(keys[nKeys], line);
+                saved[nKeys][0] = '\0';
+                if (getenv(keys[nKeys]) != NULL)
+                        strcpy(saved[nKeys], getenv(keys[nKeys]));
+                counts[nKeys] = ExpandSweep(value, &values[nKeys]);
+                if ((double)nCandidates * counts[nKeys] > MAX_TUNE_CANDIDATES)
+                        ERR("hint search space too large");
+                nCandidates *= counts[nKeys];
+                nKeys++;
+        }
+        if (fclose(file) != 0)
+                ERR("cannot close hint search file");
+        if (nKeys == 0)
+                ERR("no IOR_HINT lines in hint search file");
+
+        alive = (int *)malloc(nCandidates * sizeof(int));
+        order = (int *)malloc(nCandidates * sizeof(int));
+        lastRound = (int *)malloc(nCandidates * sizeof(int));
+        lastReps = (int *)malloc(nCandidates * sizeof(int));
+        score = (double *)malloc(nCandidates * sizeof(double));
+        writeBW = (double *)malloc(nCandidates * sizeof(double));
+        readBW = (double *)malloc(nCandidates * sizeof(double));
+        if (alive == NULL || order == NULL || lastRound == NULL || lastReps == NULL
+            || score == NULL || writeBW == NULL || readBW == NULL)
+                ERR("malloc failed");
+        for (i = 0; i < nCandidates; i++)
+                alive[i] = i;
+
+        if (rank == 0 && verbose >= VERBOSE_0) {
+                fprintf(stdout, "Tuning %d hint combinations by successive "
+                        "halving from %d repetition(s)\n", nCandidates,
+                        params->repetitions);
+                fflush(stdout);
+        }
+
+        /* successive halving; trials run quietly */
+        nAlive = nCandidates;
+        reps = params->repetitions;
+        do {
+                for (i = 0; i < nAlive; i++) {
+                        IOR_test_t *trial = CreateTest(params, params->id);
+
+                        trial->params.repetitions = reps;
+                        AllocResults(trial);
+                        SetTuneHints(keys, values, counts, nKeys, alive[i],
+                                     NULL);
+                        verbose = VERBOSE_0 - 1;
+                        TestIoSys(trial);
+                        verbose = savedVerbose;
+                        SetTuneHints(keys, values, counts, nKeys, -1, saved);
+                        j = alive[i];
+                        score[j] = TestBandwidth(trial, &writeBW[j],
+                                                 &readBW[j]);
+                        MPI_CHECK(MPI_Bcast(&score[j], 1, MPI_DOUBLE, 0,
+                                            MPI_COMM_WORLD),
+                                  "cannot broadcast trial score");
+                        lastRound[j] = round;
+                        lastReps[j] = reps;
+                        DestroyTest(trial);
+                }
+                /* keep the better half, best first */
+                for (i = 1; i < nAlive; i++) {
+                        for (j = i; j > 0 && score[alive[j]]
+                                             > score[alive[j - 1]]; j--) {
+                                k = alive[j];
+                                alive[j] = alive[j - 1];
+                                alive[j - 1] = k;
+                        }
+                }
+                nAlive = (nAlive + 1) / 2;
+                reps *= 2;
+                round++;
+        } while (nAlive > 1);
+
+        if (rank == 0 && verbose >= VERBOSE_0) {
+                /* candidates that lasted longest first, then by score */
+                for (i = 0; i < nCandidates; i++)
+                        order[i] = i;
+                for (i = 1; i < nCandidates; i++) {
+                        for (j = i; j > 0; j--) {
+                                int a = order[j], b = order[j - 1];
+                                if (lastRound[a] < lastRound[b]
+                                    || (lastRound[a] == lastRound[b]
+                                        && score[a] <= score[b]))
+                                        break;
+                                order[j] = b;
+                                order[j - 1] = a;
+                        }
+                }
+                fprintf(stdout, "\nHint tuning results:\n");
+                for (k = 0; k < nKeys; k++) {
+                        /* show the hint name without its layer prefix */
+                        value = keys[k];
+                        while (strstr(value, "__") != NULL)
+                                value = strstr(value, "__") + 2;
+                        fprintf(stdout, "%-20s ", value);
+                }
+                fprintf(stdout, "%5s %5s %10s %10s\n", "Round", "Reps",
+                        "Write(MiB)", "Read(MiB)");
+                for (i = 0; i < nCandidates; i++) {
+                        int c = order[i];
+                        for (k = 0, j = c; k < nKeys; j /= counts[k], k++)
+                                fprintf(stdout, "%-20s ",
+                                        values[k][j % counts[k]]);
+                        fprintf(stdout, "%5d %5d %10.2f %10.2f\n",
+                                lastRound[c], lastReps[c],
+                                writeBW[c] / MEBIBYTE, readBW[c] / MEBIBYTE);
+                }
+
+                /* write the winner as a hints file */
+                if (params->hintTuneFile[0] != '\0')
+                        strcpy(tuneFile, params->hintTuneFile);
+                else
+                        snprintf(tuneFile, MAXPATHLEN, "%.*s.best",
+                                 MAXPATHLEN - 6, params->hintSearchFile);
+                file = fopen(tuneFile, "w");
+                if (file == NULL)
+                        ERR("cannot open tuned hints file");
+                for (k = 0, j = alive[0]; k < nKeys; j /= counts[k], k++)
+                        fprintf(file, "%s=%s\n", keys[k],
+                                values[k][j % counts[k]]);
+                if (fclose(file) != 0)
+                        ERR("cannot close tuned hints file");
+                fprintf(stdout, "Best hints written to %s\n\n", tuneFile);
+                fflush(stdout);
+        }
+
+        /* the full test runs with the winning hints */
+        SetTuneHints(keys, values, counts, nKeys, alive[0], NULL);
+        TestIoSys(test);
+        SetTuneHints(keys, values, counts, nKeys, -1, saved);
+
+        for (k = 0; k < nKeys; k++) {
+                for (i = 0; i < counts[k]; i++)
+                        free(values[k][i]);
+                free(values[k]);
+        }
+        free(alive);
+        free(order);
+        free(lastRound);
+        free(lastReps);
+        free(score);
+        free(writeBW);
+        free(readBW);
+}
+
 /*
  * Determine if valid tests from parameters.
  */
@@ -2387,6 +4179,135 @@ static void ValidateTests(IOR_param_t * test)
         if (test->repetitions <= 0)
                 WARN_RESET("too few test repetitions",
                            test, &defaults, repetitions);
+        if (test->ciTarget < 0)
+                ERR("ciTarget must be a positive percentage");
+        if (test->ciTarget > 0 && test->minRepetitions < 2)
+                ERR("ciTarget needs minRepetitions of at least 2");
+        if (test->ciTarget > 0 && test->minRepetitions > test->repetitions)
+                ERR("minRepetitions exceeds the repetitions (-i) limit");
+        if (test->warmupRepetitions < 0)
+                ERR("warmupRepetitions must not be negative");
+        if (test->cacheMode != cache_any
+            && (strcmp(test->api, "HDFS") == 0
+                || strncmp(test->api, "S3", 2) == 0))
+                ERR("cacheMode needs test files in a local file system");
+        if (test->bufferPool < 1)
+                ERR("bufferPool must be at least 1");
+        if (test->bufferPool > 1
+            && (test->twoPhase || test->useStridedDatatype
+                || test->workStealing || test->useSharedFilePointer
+                || test->virtualRanks > 1 || test->writerTasks > 0
+                || (test->randomOffset && test->collective
+                    && strcmp(test->api, "MPIIO") == 0)))
+                WARN_RESET("buffer pool not used with this access pattern",
+                           test, &defaults, bufferPool);
+        if (test->fillPipeline && test->bufferPool == 1
+            && (test->twoPhase || test->useStridedDatatype
+                || test->workStealing || test->useSharedFilePointer
+                || test->virtualRanks > 1 || test->writerTasks > 0
+                || (test->randomOffset && test->collective
+                    && strcmp(test->api, "MPIIO") == 0)))
+                WARN_RESET("fill pipeline not used with this access pattern",
+                           test, &defaults, fillPipeline);
+        if (test->fillPipeline && mpiThreadLevel < MPI_THREAD_FUNNELED)
+                WARN_RESET("fill pipeline needs MPI_THREAD_FUNNELED support",
+                           test, &defaults, fillPipeline);
+        /* the helper fills the next transfer's buffer while one moves */
+        if (test->fillPipeline && test->bufferPool < 2)
+                test->bufferPool = 2;
+        if (test->bufferBudget < 0)
+                ERR("bufferBudget must not be negative");
+        if (test->bufferBudget > 0 && test->bufferBudget < test->transferSize)
+                ERR("bufferBudget is smaller than one transfer");
+        if (test->bufferBudget > 0
+            && test->bufferPool * test->transferSize > test->bufferBudget) {
+                test->bufferPool = test->bufferBudget / test->transferSize;
+                if (rank == 0)
+                        fprintf(stdout, "ior WARNING: buffer pool over "
+                                "bufferBudget.  Using %d buffers.\n",
+                                test->bufferPool);
+        }
+        if (test->compressRatio != 0 || test->dedupRatio != 0) {
+                if ((test->compressRatio != 0 && test->compressRatio < 1)
+                    || (test->dedupRatio != 0 && test->dedupRatio < 1))
+                        ERR("compressRatio and dedupRatio must be at least 1");
+                if (test->dataPacketType == timestamp
+                    || test->dataPacketType == incompressible)
+                        ERR("compressRatio and dedupRatio replace the -l data packet");
+                if (test->dedupBlockSize <= 0
+                    || test->dedupBlockSize % sizeof(unsigned long long) != 0
+                    || test->transferSize % test->dedupBlockSize != 0)
+                        ERR("dedupBlockSize must be a multiple of 8 bytes dividing the transfer size");
+                /* the data depends on where it lands in the file */
+                test->dataPacketType = tunable;
+                test->storeFileOffset = TRUE;
+        }
+        if (test->burstSize < 0 || test->computeTime < 0)
+                ERR("burstSize and computeTime must not be negative");
+        if (test->burstSize > 0 && test->transferSize > 0
+            && test->burstSize % test->transferSize != 0)
+                ERR("burstSize must be a multiple of transferSize");
+        if (test->burstSize > 0
+            && (test->twoPhase || test->useStridedDatatype
+                || test->workStealing || test->useSharedFilePointer
+                || test->writerTasks > 0 || test->deadlineForStonewalling
+                || test->nonblockingWindow > 0
+                || (test->randomOffset && test->collective
+                    && strcmp(test->api, "MPIIO") == 0)))
+                ERR("bursts need every task to make the same independent, blocking transfers");
+        if (test->burstSize > 0
+            && (test->paceRate > 0 || test->paceBandwidth > 0))
+                ERR("bursts and pacing do not mix");
+        if (test->computeBurn && test->memoryPerTask == 0
+            && test->memoryPerNode == 0)
+                ERR("computeBurn needs memoryPerTask or memoryPerNode");
+        if (test->paceRate < 0 || test->paceBandwidth < 0)
+                ERR("paceRate and paceBandwidth must not be negative");
+        if (test->paceRate > 0 && test->paceBandwidth > 0)
+                ERR("set paceRate or paceBandwidth, not both");
+        if ((test->paceRate > 0 || test->paceBandwidth > 0)
+            && (test->twoPhase || test->useStridedDatatype
+                || test->workStealing || test->nonblockingWindow > 0
+                || (test->randomOffset && test->collective
+                    && strcmp(test->api, "MPIIO") == 0)))
+                ERR("pacing needs one blocking transfer at a time");
+        if (test->delayLatency < 0 || test->delayJitter < 0)
+                ERR("delayLatency and delayJitter must not be negative");
+        if (strstr(test->apiLayers, "throttle") != NULL
+            && test->throttleBandwidth <= 0)
+                ERR("throttle layer needs a throttleBandwidth");
+        /* without copies there is no data to check */
+        if (strcmp(test->api, "MEM") == 0 && !test->memCopy) {
+                if (test->checkWrite)
+                        WARN_RESET("write check not available without memCopy",
+                                   test, &defaults, checkWrite);
+                if (test->checkRead)
+                        WARN_RESET("read check not available without memCopy",
+                                   test, &defaults, checkRead);
+        }
+        if (test->compressor[0] != '\0') {
+                COMPRESS_Codec(test->compressor);
+                if (strcmp(test->api, "POSIX") != 0
+                    && strcmp(test->api, "MPIIO") != 0
+                    && strcmp(test->api, "MEM") != 0)
+                        ERR("compressor needs the POSIX, MPIIO, or MEM API");
+                if (test->collective || test->useFileView
+                    || test->useStridedDatatype || test->useSharedFilePointer
+                    || test->nonblockingWindow > 0 || test->twoPhase
+                    || test->subarrayDims > 0)
+                        ERR("compressor needs independent I/O at explicit offsets");
+                if (test->useO_DIRECT || test->cacheMode == cache_direct)
+                        ERR("compressed records are not aligned for O_DIRECT");
+        }
+        if (test->hugePages < -1 || (test->hugePages > 0
+            && (test->hugePages & (test->hugePages - 1)) != 0))
+                ERR("hugePages must be thp or a power-of-two page size");
+        if (test->cacheMode == cache_direct && strcmp(test->api, "POSIX") != 0)
+                ERR("cacheMode=direct needs the POSIX API");
+#if !defined(O_DIRECT) && !defined(O_DIRECTIO)
+        if (test->cacheMode == cache_direct)
+                ERR("cacheMode=direct needs O_DIRECT, not available here");
+#endif
         if (test->numTasks <= 0)
                 ERR("too few tasks for testing");
         if (test->interTestDelay < 0)
@@ -2452,15 +4373,63 @@ static void ValidateTests(IOR_param_t * test)
         if ((strcmp(test->api, "MPIIO") != 0) && test->useSharedFilePointer)
                 WARN_RESET("shared file pointer only available in MPIIO",
                            test, &defaults, useSharedFilePointer);
-        if ((strcmp(test->api, "MPIIO") == 0) && test->useSharedFilePointer)
-                WARN_RESET("shared file pointer not implemented",
-                           test, &defaults, useSharedFilePointer);
+        if (test->useSharedFilePointer
+            && (test->useFileView || test->randomOffset
+                || test->tasksPerFile || test->subarrayDims
+                || test->virtualRanks > 1 || test->writerTasks > 0
+                || test->twoPhase || test->workStealing))
+                ERR("shared file pointer appends transfers in turn; not available with file views, random offsets, or other layouts");
+        if (test->useSharedFilePointer && !test->collective
+            && test->checkWrite && (test->dataPacketType == incompressible
+                                    || test->dataPacketType == tunable
+                                    || test->transferSize
+                                       < (IOR_offset_t)(2 * sizeof(IOR_size_t))))
+                WARN_RESET("write check of unordered shared-pointer appends needs a data pattern naming its writer",
+                           test, &defaults, checkWrite);
+        /* each unordered append is stamped with its writer and slot */
+        if (test->useSharedFilePointer && !test->collective
+            && test->checkWrite)
+                test->storeFileOffset = TRUE;
+        if (test->hintSearchFile[0] != '\0'
+            && (strcmp(test->api, "MPIIO") != 0)
+            && (strcmp(test->api, "HDF5") != 0)
+            && (strcmp(test->api, "NCMPI") != 0))
+                ERR("hint tuning only available with MPIIO, HDF5, or NCMPI");
+        if (test->hintSearchFile[0] != '\0'
+            && (test->checkWrite || test->checkRead))
+                ERR("hint tuning trials do not check data; disable checkWrite and checkRead");
+        if ((strcmp(test->api, "MPIIO") != 0) && test->nonblockingWindow)
+                WARN_RESET("nonblocking window only available in MPIIO",
+                           test, &defaults, nonblockingWindow);
+        if (test->nonblockingWindow < 0)
+                ERR("nonblocking window must be nonnegative");
+        if (test->nonblockingWindow > 0
+            && (test->useFileView || test->useSharedFilePointer))
+                ERR("nonblocking window requires explicit offsets, without file views or shared file pointers");
+        if (test->nonblockingWindow > 0
+            && (test->twoPhase || test->workStealing || test->virtualRanks > 1
+                || test->writerTasks > 0))
+                ERR("nonblocking window not available with two-phase I/O, work stealing, virtual ranks, or restart layout");
         if ((strcmp(test->api, "MPIIO") != 0) && test->useStridedDatatype)
                 WARN_RESET("strided datatype only available in MPIIO",
                            test, &defaults, useStridedDatatype);
-        if ((strcmp(test->api, "MPIIO") == 0) && test->useStridedDatatype)
-                WARN_RESET("strided datatype not implemented",
-                           test, &defaults, useStridedDatatype);
+        if (test->useStridedDatatype) {
+                /* the strided pattern is described by the file view */
+                if (!test->useFileView) {
+                        test->useFileView = TRUE;
+                        if (rank == 0)
+                                fprintf(stdout, "ior WARNING: strided datatype "
+                                        "requires a file view.  Using value of %d.\n",
+                                        test->useFileView);
+                }
+                if (test->blockSize * test->segmentCount > INT_MAX)
+                        ERR("strided datatype limited to 2GB per task");
+                if (test->randomOffset || test->subarrayDims)
+                        ERR("strided datatype not available with random offsets or subarray layout");
+                if (test->checkRead)
+                        WARN_RESET("read check not available with strided datatype",
+                                   test, &defaults, checkRead);
+        }
         if ((strcmp(test->api, "MPIIO") == 0)
             && test->useStridedDatatype && (test->blockSize < sizeof(IOR_size_t)
                                             || test->transferSize <
@@ -2469,13 +4438,114 @@ static void ValidateTests(IOR_param_t * test)
         if ((strcmp(test->api, "POSIX") == 0) && test->showHints)
                 WARN_RESET("hints not available in POSIX",
                            test, &defaults, showHints);
-        if ((strcmp(test->api, "POSIX") == 0) && test->collective)
-                WARN_RESET("collective not available in POSIX",
-                           test, &defaults, collective);
+        if (test->collective && !BackendHasCollective(test->api))
+                test->twoPhase = TRUE;
+        if (test->twoPhase && test->filePerProc)
+                WARN_RESET("two-phase I/O only available with single-shared-file",
+                           test, &defaults, twoPhase);
+        if (test->twoPhase && ((strcmp(test->api, "HDF5") == 0)
+                               || (strcmp(test->api, "NCMPI") == 0)))
+                ERR("two-phase I/O not available with HDF5 or NCMPI");
+        if (test->twoPhase && (strcmp(test->api, "MPIIO") == 0)
+            && (test->collective || test->useFileView))
+                ERR("two-phase I/O requires independent MPIIO without file views");
+        if (test->twoPhase && test->twoPhaseBufferSize <= 0)
+                ERR("two-phase buffer size must be a positive value");
+        if (test->twoPhase && test->twoPhaseAggregators < 0)
+                ERR("two-phase aggregator count must be nonnegative");
+        if (test->virtualRanks < 1)
+                ERR("virtual ranks per task must be a positive value");
+        if (test->virtualRanks > 1 && test->checkRead)
+                WARN_RESET("read check not available with virtual ranks",
+                           test, &defaults, checkRead);
+        if (test->virtualRanks > 1 && (test->twoPhase || test->workStealing))
+                ERR("virtual ranks not available with two-phase I/O or work stealing");
+        if (test->virtualRanks > 1 && ((strcmp(test->api, "HDF5") == 0)
+                                       || (strcmp(test->api, "NCMPI") == 0)))
+                ERR("virtual ranks not available with HDF5 or NCMPI");
+        if (test->virtualRanks > 1
+            && (test->useFileView || test->useStridedDatatype))
+                ERR("virtual ranks not available with file views or strided datatypes");
+        if (test->subarrayDims > 0) {
+                int d, tasks = 1;
+                for (d = 0; d < test->subarrayDims; d++)
+                        tasks *= test->processGrid[d];
+                if (tasks != test->numTasks)
+                        ERR("process grid must have one entry per task");
+                if (test->elementSize <= 0)
+                        ERR("element size must be a positive value");
+                if (test->filePerProc || test->randomOffset
+                    || test->tasksPerFile || test->virtualRanks > 1
+                    || test->workStealing || test->useStridedDatatype)
+                        ERR("subarray layout requires a single shared file with sequential offsets");
+                if ((strcmp(test->api, "HDF5") == 0)
+                    || (strcmp(test->api, "NCMPI") == 0))
+                        ERR("subarray layout not available with HDF5 or NCMPI");
+                if (test->checkRead)
+                        WARN_RESET("read check not available with subarray layout",
+                                   test, &defaults, checkRead);
+        }
+        if (test->writerTasks < 0)
+                ERR("writer task count must be nonnegative");
+        if (test->writerTasks > 0) {
+                if (test->restartBlockSize < 0
+                    || test->restartBlockSize % test->transferSize != 0)
+                        ERR("restart block size must be a multiple of transfer size");
+                if (test->filePerProc || test->randomOffset
+                    || test->tasksPerFile || test->virtualRanks > 1
+                    || test->subarrayDims || test->workStealing
+                    || test->twoPhase || test->useFileView
+                    || test->useStridedDatatype)
+                        ERR("restart layout requires a single shared file with sequential offsets");
+                if ((strcmp(test->api, "HDF5") == 0)
+                    || (strcmp(test->api, "NCMPI") == 0))
+                        ERR("restart layout not available with HDF5 or NCMPI");
+                if (test->collective)
+                        ERR("restart layout gives tasks unequal transfer counts; collective I/O not allowed");
+        }
+        if (test->tasksPerFile && test->filePerProc)
+                WARN_RESET("tasksPerFile not used with file-per-process",
+                           test, &defaults, tasksPerFile);
+        if (test->tasksPerFile < 0)
+                ERR("tasks per file must be nonnegative");
+        if (test->tasksPerFile && (test->numTasks % test->tasksPerFile) != 0)
+                ERR("number of tasks must be a multiple of tasksPerFile");
+        if (test->tasksPerFile && (strcmp(test->api, "POSIX") != 0)
+            && (strcmp(test->api, "MPIIO") != 0)
+            && (strcmp(test->api, "MEM") != 0))
+                ERR("tasksPerFile only available with POSIX, MPIIO, and MEM");
+        if (test->tasksPerFile && test->checkRead)
+                WARN_RESET("read check not available with tasksPerFile",
+                           test, &defaults, checkRead);
+        if (test->tasksPerFile && (test->twoPhase || test->workStealing
+                                   || test->virtualRanks > 1))
+                ERR("tasksPerFile not available with two-phase I/O, work stealing, or virtual ranks");
+        if (test->workStealing && test->filePerProc)
+                WARN_RESET("work stealing only available with single-shared-file",
+                           test, &defaults, workStealing);
+        if (test->workStealingPerNode && !test->workStealing)
+                WARN_RESET("per-node work counters require work stealing",
+                           test, &defaults, workStealingPerNode);
+        if (test->workStealing && test->randomOffset)
+                ERR("work stealing assigns offsets itself; random offsets not allowed");
+        if (test->workStealing && (test->collective || test->twoPhase))
+                ERR("work stealing not available with collective I/O");
+        if (test->workStealing && (test->useFileView || test->useStridedDatatype))
+                ERR("work stealing not available with file views or strided datatypes");
+        if (test->workStealing && ((strcmp(test->api, "HDF5") == 0)
+                                   || (strcmp(test->api, "NCMPI") == 0)
+                                   || (strcmp(test->api, "HDFS") == 0)))
+                ERR("work stealing not available with HDF5, NCMPI, or HDFS");
 
         /* parameter consitency */
         if (test->reorderTasks == TRUE && test->reorderTasksRandom == TRUE)
                 ERR("Both Constant and Random task re-ordering specified. Choose one and resubmit");
+        if (test->reorderTasksTopology
+            && (test->reorderTasks || test->reorderTasksRandom))
+                ERR("Both topology and Constant or Random task re-ordering specified. Choose one and resubmit");
+        if (test->randomOffset && test->reorderTasksTopology
+            && test->filePerProc == FALSE)
+                ERR("random offset and topology reorder tasks specified with single-shared-file. Choose one and resubmit");
         if (test->randomOffset && test->reorderTasksRandom
             && test->filePerProc == FALSE)
                 ERR("random offset and random reorder tasks specified with single-shared-file. Choose one and resubmit");
@@ -2489,8 +4559,15 @@ static void ValidateTests(IOR_param_t * test)
 
 
         if ((strcmp(test->api, "MPIIO") == 0) && test->randomOffset
-            && test->collective)
-                ERR("random offset not available with collective MPIIO");
+            && test->collective) {
+                if (test->randomBatch < 1)
+                        ERR("random batch must be at least one transfer");
+                if ((IOR_offset_t)test->randomBatch * test->transferSize
+                    > INT_MAX)
+                        ERR("random batch limited to 2GB per round");
+                if (test->nonblockingWindow > 0 || test->virtualRanks > 1)
+                        ERR("collective random rounds not available with nonblocking window or virtual ranks");
+        }
         if ((strcmp(test->api, "MPIIO") == 0) && test->randomOffset
             && test->useFileView)
                 ERR("random offset not available with MPIIO fileviews");
@@ -2537,11 +4614,20 @@ static void ValidateTests(IOR_param_t * test)
         IOR_offset_t  t    = test->transferSize;
         IOR_offset_t  b    = test->blockSize;
 
-        if (Nto1 && (s != 1) && (b != t)) {
+        if (Nto1 && (s != 1) && (b != t) && (test->subarrayDims == 0)
+            && !test->useSharedFilePointer && !test->useStridedDatatype) {
                 ERR("N:1 (strided) requires xfer-size == block-size");
         }
 }
 
+/*
+ * Number of tasks sharing each file in the shared-file layout.
+ */
+static int TasksPerFile(IOR_param_t * test)
+{
+        return test->tasksPerFile ? test->tasksPerFile : test->numTasks;
+}
+
 static IOR_offset_t *GetOffsetArraySequential(IOR_param_t * test,
                                               int pretendRank)
 {
@@ -2567,8 +4653,9 @@ static IOR_offset_t *GetOffsetArraySequential(IOR_param_t * test,
                                 offsetArray[k] += i * test->blockSize;
                         } else {
                                 offsetArray[k] +=
-                                        (i * test->numTasks * test->blockSize)
-                                        + (pretendRank * test->blockSize);
+                                        (i * TasksPerFile(test) * test->blockSize)
+                                        + ((pretendRank % TasksPerFile(test))
+                                           * test->blockSize);
                         }
                         k++;
                 }
@@ -2577,6 +4664,145 @@ static IOR_offset_t *GetOffsetArraySequential(IOR_param_t * test,
         return (offsetArray);
 }
 
+/*
+ * Offsets of transfers appended through a shared file pointer.  Ordered
+ * (collective) appends place each task's k-th transfer at
+ * (k * numTasks + rank) * transferSize; unordered appends land anywhere, and
+ * these offsets then serve only to label and check the data.
+ */
+static IOR_offset_t *GetOffsetArraySharedPointer(IOR_param_t * test,
+                                                 int pretendRank)
+{
+        IOR_offset_t i, offsets;
+        IOR_offset_t *offsetArray;
+        int tasks = test->filePerProc ? 1 : test->numTasks;
+
+        offsets = (test->blockSize / test->transferSize) * test->segmentCount;
+        offsetArray =
+                (IOR_offset_t *) malloc((offsets + 1) * sizeof(IOR_offset_t));
+        if (offsetArray == NULL)
+                ERR("malloc() failed");
+        offsetArray[offsets] = -1;      /* set last offset with -1 */
+
+        for (i = 0; i < offsets; i++)
+                offsetArray[i] = (i * tasks + (test->filePerProc ? 0
+                                               : pretendRank))
+                                 * test->transferSize;
+
+        return (offsetArray);
+}
+
+/*
+ * Offsets of the contiguous runs of a task's subarray, one per transfer,
+ * repeated for each segment.  Through an MPIIO file view the subarray is
+ * accessed whole, so only the start of each segment is given.
+ */
+static IOR_offset_t *GetOffsetArraySubarray(IOR_param_t * test,
+                                            int pretendRank)
+{
+        int d, nd = test->subarrayDims;
+        int start[3], local[3], idx[3];
+        IOR_offset_t stride[3];
+        IOR_offset_t i, r, runs, element, k = 0;
+        IOR_offset_t segmentSize = test->numTasks * test->blockSize;
+        IOR_offset_t *offsetArray;
+
+        SubarrayStart(test, pretendRank, start);
+        stride[nd - 1] = 1;
+        for (d = nd - 1; d >= 0; d--) {
+                local[d] = test->globalDims[d] / test->processGrid[d];
+                if (d > 0)
+                        stride[d - 1] = stride[d] * test->globalDims[d];
+        }
+        runs = test->blockSize / test->transferSize;
+
+        offsetArray = (IOR_offset_t *)malloc((runs * test->segmentCount + 1)
+                                             * sizeof(IOR_offset_t));
+        if (offsetArray == NULL)
+                ERR("malloc() failed");
+
+        for (i = 0; i < test->segmentCount; i++) {
+                if (test->useFileView) {
+                        offsetArray[k++] = i * segmentSize;
+                        continue;
+                }
+                for (r = 0; r < runs; r++) {
+                        /* local index of this run's first element */
+                        IOR_offset_t rest = r;
+                        idx[nd - 1] = 0;
+                        for (d = nd - 2; d >= 0; d--) {
+                                idx[d] = rest % local[d];
+                                rest /= local[d];
+                        }
+                        element = 0;
+                        for (d = 0; d < nd; d++)
+                                element += (start[d] + idx[d]) * stride[d];
+                        offsetArray[k++] = i * segmentSize
+                                           + element * test->elementSize;
+                }
+        }
+        offsetArray[k] = -1;
+
+        return (offsetArray);
+}
+
+/*
+ * Offsets for a restart test, where the file was written by writerTasks
+ * tasks but is accessed by numTasks tasks.  Writes follow the writers'
+ * layout, with this task writing every numTasks-th writer's data.  Other
+ * accesses split the file evenly among the tasks, or round-robin in blocks
+ * of restartBlockSize.  'owner' receives the writer of each offset.
+ */
+static IOR_offset_t *GetOffsetArrayRestart(IOR_param_t * test, int pretendRank,
+                                           int access, int **owner)
+{
+        IOR_offset_t writerBlocks = test->writerTasks * test->blockSize;
+        IOR_offset_t fileSize = writerBlocks * test->segmentCount;
+        IOR_offset_t transfers = fileSize / test->transferSize;
+        IOR_offset_t i, j, offsets = 0, first, last;
+        IOR_offset_t *offsetArray;
+        int w;
+
+        /* the largest possible count is that of a single task */
+        offsetArray = (IOR_offset_t *)malloc((transfers + 1)
+                                             * sizeof(IOR_offset_t));
+        *owner = (int *)malloc((transfers + 1) * sizeof(int));
+        if (offsetArray == NULL || *owner == NULL)
+                ERR("malloc() failed");
+
+        if (access == WRITE) {
+                for (w = pretendRank; w < test->writerTasks;
+                     w += test->numTasks) {
+                        for (i = 0; i < test->segmentCount; i++) {
+                                for (j = 0; j < test->blockSize;
+                                     j += test->transferSize) {
+                                        offsetArray[offsets++] = i * writerBlocks
+                                                + w * test->blockSize + j;
+                                }
+                        }
+                }
+        } else if (test->restartBlockSize == 0) {
+                first = (transfers * pretendRank) / test->numTasks;
+                last = (transfers * (pretendRank + 1)) / test->numTasks;
+                for (j = first; j < last; j++)
+                        offsetArray[offsets++] = j * test->transferSize;
+        } else {
+                for (i = pretendRank * test->restartBlockSize; i < fileSize;
+                     i += test->numTasks * test->restartBlockSize) {
+                        for (j = i; j < i + test->restartBlockSize
+                                    && j < fileSize; j += test->transferSize)
+                                offsetArray[offsets++] = j;
+                }
+        }
+        offsetArray[offsets] = -1;
+
+        for (i = 0; i < offsets; i++)
+                (*owner)[i] = (int)((offsetArray[i] % writerBlocks)
+                                    / test->blockSize);
+
+        return (offsetArray);
+}
+
 static IOR_offset_t *GetOffsetArrayRandom(IOR_param_t * test, int pretendRank,
                                           int access)
 {
@@ -2597,13 +4823,14 @@ static IOR_offset_t *GetOffsetArrayRandom(IOR_param_t * test, int pretendRank,
 
         fileSize = test->blockSize * test->segmentCount;
         if (test->filePerProc == FALSE) {
-                fileSize *= test->numTasks;
+                fileSize *= TasksPerFile(test);
+                pretendRank %= TasksPerFile(test);
         }
 
         /* count needed offsets (pass 1) */
         for (i = 0; i < fileSize; i += test->transferSize) {
                 if (test->filePerProc == FALSE) {
-                        if ((random() % test->numTasks) == pretendRank) {
+                        if ((random() % TasksPerFile(test)) == pretendRank) {
                                 offsets++;
                         }
                 } else {
@@ -2627,7 +4854,7 @@ static IOR_offset_t *GetOffsetArrayRandom(IOR_param_t * test, int pretendRank,
                 /* fill with offsets (pass 2) */
                 srandom(seed);  /* need same seed */
                 for (i = 0; i < fileSize; i += test->transferSize) {
-                        if ((random() % test->numTasks) == pretendRank) {
+                        if ((random() % TasksPerFile(test)) == pretendRank) {
                                 offsetArray[offsetCnt] = i;
                                 offsetCnt++;
                         }
@@ -2646,53 +4873,1499 @@ static IOR_offset_t *GetOffsetArrayRandom(IOR_param_t * test, int pretendRank,
 }
 
 /*
- * Write or Read data to file(s).  This loops through the strides, writing
- * out the data to each block in transfer sizes, until the remainder left is 0.
+ * Offsets for all virtual ranks of this task, interleaved one transfer per
+ * virtual rank in turn.  The offset math uses the virtual task count, and
+ * 'owner' receives the virtual rank index (0..virtualRanks-1) of each entry.
  */
-static IOR_offset_t WriteOrRead(IOR_param_t * test, void *fd, int access, IOR_io_buffers* ioBuffers)
+static IOR_offset_t *GetOffsetArrayVirtual(IOR_param_t * test, int pretendRank,
+                                           int access, int **owner)
 {
-        int errors = 0;
-        IOR_offset_t amtXferred;
-        IOR_offset_t transfer;
-        IOR_offset_t transferCount = 0;
-        IOR_offset_t pairCnt = 0;
-        IOR_offset_t *offsetArray;
-        int pretendRank;
-        void *buffer = ioBuffers->buffer;
+        IOR_param_t virtualTest = *test;
+        IOR_offset_t **arrays, *offsetArray;
+        IOR_offset_t offsets = 0, *next;
+        int k, left, K = test->virtualRanks;
+
+        virtualTest.numTasks = test->numTasks * K;
+        arrays = (IOR_offset_t **)malloc(K * sizeof(IOR_offset_t *));
+        next = (IOR_offset_t *)malloc(K * sizeof(IOR_offset_t));
+        if (arrays == NULL || next == NULL)
+                ERR("malloc() failed");
+        for (k = 0; k < K; k++) {
+                if (test->randomOffset) {
+                        /* later virtual ranks reuse the first one's seed */
+                        arrays[k] = GetOffsetArrayRandom(&virtualTest,
+                                                         pretendRank * K + k,
+                                                         k == 0 ? access
+                                                         : WRITECHECK);
+                } else {
+                        arrays[k] = GetOffsetArraySequential(&virtualTest,
+                                                             pretendRank * K + k);
+                }
+                for (next[k] = 0; arrays[k][next[k]] != -1; next[k]++)
+                        offsets++;
+                next[k] = 0;
+        }
+        test->randomSeed = virtualTest.randomSeed;
+
+        offsetArray = (IOR_offset_t *)malloc((offsets + 1)
+                                             * sizeof(IOR_offset_t));
+        *owner = (int *)malloc((offsets + 1) * sizeof(int));
+        if (offsetArray == NULL || *owner == NULL)
+                ERR("malloc() failed");
+        offsets = 0;
+        do {
+                left = 0;
+                for (k = 0; k < K; k++) {
+                        if (arrays[k][next[k]] == -1)
+                                continue;
+                        (*owner)[offsets] = k;
+                        offsetArray[offsets++] = arrays[k][next[k]++];
+                        left = 1;
+                }
+        } while (left);
+        offsetArray[offsets] = -1;
+
+        for (k = 0; k < K; k++)
+                free(arrays[k]);
+        free(arrays);
+        free(next);
+
+        return (offsetArray);
+}
+
+/*
+ * Backends that implement their own collective I/O path.  For all others,
+ * collective access is provided by IOR's two-phase implementation.
+ */
+static int BackendHasCollective(char *api)
+{
+        return (strcmp(api, "MPIIO") == 0
+                || strcmp(api, "HDF5") == 0
+                || strcmp(api, "NCMPI") == 0);
+}
+
+/*
+ * Number of two-phase aggregators; the default is one per node.
+ */
+static int TwoPhaseAggregatorCount(IOR_param_t * test)
+{
+        int aggregators = test->twoPhaseAggregators;
+
+        if (aggregators == 0)
+                aggregators = test->numTasks / test->tasksPerNode;
+        if (aggregators < 1)
+                aggregators = 1;
+        if (aggregators > test->numTasks)
+                aggregators = test->numTasks;
+        return aggregators;
+}
+
+/* a piece of a transfer that falls in one aggregator's window in one round */
+typedef struct {
+        IOR_offset_t offset;            /* file offset of piece */
+        IOR_offset_t length;            /* length of piece */
+        IOR_offset_t xferOffset;        /* file offset of containing transfer */
+        int aggregator;                 /* index of aggregator owning piece */
+        int round;                      /* round in which piece is accessed */
+} two_phase_piece_t;
+
+static int TwoPhaseComparePieces(const void *a, const void *b)
+{
+        const two_phase_piece_t *x = (const two_phase_piece_t *)a;
+        const two_phase_piece_t *y = (const two_phase_piece_t *)b;
+
+        if (x->round != y->round)
+                return x->round - y->round;
+        if (x->aggregator != y->aggregator)
+                return x->aggregator - y->aggregator;
+        return (x->offset > y->offset) - (x->offset < y->offset);
+}
+
+static int TwoPhaseCompareOffsets(const void *a, const void *b)
+{
+        const IOR_offset_t *x = (const IOR_offset_t *)a;
+        const IOR_offset_t *y = (const IOR_offset_t *)b;
+
+        return (x[0] > y[0]) - (x[0] < y[0]);
+}
+
+/*
+ * Two-phase I/O for backends without a collective path.  The file range
+ * accessed by all tasks is split into one contiguous domain per aggregator,
+ * and each domain is processed in rounds of twoPhaseBufferSize bytes.  In
+ * each round, tasks exchange (offset, length) pairs and data with the
+ * aggregators through MPI_Alltoallv, and the aggregators issue one
+ * backend->xfer() per contiguous run in their collective buffer.
+ *
+ * All tasks in testComm must call this, with the same number of rounds.
+ */
+static IOR_offset_t TwoPhaseXfer(IOR_param_t * test, void *fd, int access,
+                                 IOR_io_buffers * ioBuffers,
+                                 IOR_offset_t * offsetArray, int pretendRank)
+{
+        IOR_offset_t localRange[2], globalRange[2];
+        IOR_offset_t domainSize, bufferSize, windowStart, windowEnd;
+        IOR_offset_t cur, end, i, j;
+        IOR_offset_t nPieces = 0, maxPieces;
+        IOR_offset_t dataMoved = 0;
+        IOR_offset_t amtXferred;
+        IOR_offset_t lastFill = -1;
+        IOR_offset_t *sendMeta, *recvMeta, *runs;
+        two_phase_piece_t *pieces;
+        IOR_offset_t *roundStart;
+        IOR_offset_t nPairs;
+        char *collBuffer = NULL;
+        char *sendData = NULL, *recvData = NULL;
+        size_t sendDataSize = 0, recvDataSize = 0;
+        int *sendCounts, *recvCounts, *sendDispls, *recvDispls;
+        int *aggRank;
+        int aggregators, myAggregator = -1;
+        int nTasks = test->numTasks;
+        int rounds, round, a, p, hitStonewall = 0;
+        double startForStonewall;
+        char *buffer = (char *)ioBuffers->buffer;
+
+        aggregators = TwoPhaseAggregatorCount(test);
+        aggRank = (int *)malloc(aggregators * sizeof(int));
+        if (aggRank == NULL)
+                ERR("malloc() failed");
+        for (a = 0; a < aggregators; a++) {
+                aggRank[a] = (int)(((long long)a * nTasks) / aggregators);
+                if (aggRank[a] == rank)
+                        myAggregator = a;
+        }
+
+        /* find the extent of the file accessed by all tasks; the start is
+           negated so that a single MPI_MAX reduction finds both ends */
+        localRange[0] = -LLONG_MAX;
+        localRange[1] = 0;
+        for (i = 0; offsetArray[i] != -1; i++) {
+                localRange[0] = MAX(localRange[0], -offsetArray[i]);
+                localRange[1] = MAX(localRange[1],
+                                    offsetArray[i] + test->transferSize);
+        }
+        MPI_CHECK(MPI_Allreduce(localRange, globalRange, 2, MPI_LONG_LONG_INT,
+                                MPI_MAX, testComm),
+                  "cannot reduce two-phase file range");
+        globalRange[0] = -globalRange[0];
+        if (globalRange[1] <= globalRange[0]) {
+                free(aggRank);
+                return 0;
+        }
+
+        /* domains are aligned to the transfer size */
+        domainSize = (globalRange[1] - globalRange[0] + aggregators - 1)
+                     / aggregators;
+        domainSize = ((domainSize + test->transferSize - 1)
+                      / test->transferSize) * test->transferSize;
+        bufferSize = MIN(test->twoPhaseBufferSize, domainSize);
+        rounds = (int)((domainSize + bufferSize - 1) / bufferSize);
+
+        /* split each transfer into pieces by aggregator window */
+        maxPieces = 0;
+        for (i = 0; offsetArray[i] != -1; i++)
+                maxPieces += test->transferSize / bufferSize + 2;
+        pieces = (two_phase_piece_t *)malloc((maxPieces + 1)
+                                             * sizeof(two_phase_piece_t));
+        roundStart = (IOR_offset_t *)malloc((rounds + 1)
+                                            * sizeof(IOR_offset_t));
+        if (pieces == NULL || roundStart == NULL)
+                ERR("malloc() failed");
+        memset(roundStart, 0, (rounds + 1) * sizeof(IOR_offset_t));
+        for (i = 0; offsetArray[i] != -1; i++) {
+                cur = offsetArray[i];
+                end = cur + test->transferSize;
+                while (cur < end) {
+                        a = (int)((cur - globalRange[0]) / domainSize);
+                        windowStart = globalRange[0] + a * domainSize;
+                        round = (int)((cur - windowStart) / bufferSize);
+                        windowEnd = MIN(windowStart + (round + 1) * bufferSize,
+                                        windowStart + domainSize);
+                        pieces[nPieces].offset = cur;
+                        pieces[nPieces].length = MIN(end, windowEnd) - cur;
+                        pieces[nPieces].xferOffset = offsetArray[i];
+                        pieces[nPieces].aggregator = a;
+                        pieces[nPieces].round = round;
+                        roundStart[round + 1]++;
+                        cur += pieces[nPieces].length;
+                        nPieces++;
+                }
+        }
+        /* order pieces by round, then by aggregator (i.e., destination) */
+        for (round = 0; round < rounds; round++)
+                roundStart[round + 1] += roundStart[round];
+        qsort(pieces, nPieces, sizeof(two_phase_piece_t),
+              TwoPhaseComparePieces);
+
+        sendCounts = (int *)malloc(4 * nTasks * sizeof(int));
+        if (sendCounts == NULL)
+                ERR("malloc() failed");
+        recvCounts = sendCounts + nTasks;
+        sendDispls = recvCounts + nTasks;
+        recvDispls = sendDispls + nTasks;
+        sendMeta = (IOR_offset_t *)malloc((2 * nPieces + 1)
+                                          * sizeof(IOR_offset_t));
+        if (sendMeta == NULL)
+                ERR("malloc() failed");
+        recvMeta = NULL;
+        runs = NULL;
+        if (myAggregator >= 0) {
+                collBuffer = aligned_buffer_alloc(bufferSize);
+        }
+
+        startForStonewall = GetTimeStamp();
+        for (round = 0; round < rounds && !hitStonewall; round++) {
+                IOR_offset_t first = roundStart[round];
+                IOR_offset_t last = roundStart[round + 1];
+                IOR_offset_t nRecv = 0, nRuns = 0, bytes = 0;
+                int total;
+
+                /* phase 1: exchange (offset, length) pairs */
+                memset(sendCounts, 0, 4 * nTasks * sizeof(int));
+                for (i = first; i < last; i++) {
+                        p = aggRank[pieces[i].aggregator];
+                        sendMeta[2 * (i - first)] = pieces[i].offset;
+                        sendMeta[2 * (i - first) + 1] = pieces[i].length;
+                        sendCounts[p] += 2;
+                }
+                for (p = 1; p < nTasks; p++)
+                        sendDispls[p] = sendDispls[p - 1] + sendCounts[p - 1];
+                MPI_CHECK(MPI_Alltoall(sendCounts, 1, MPI_INT, recvCounts, 1,
+                                       MPI_INT, testComm),
+                          "cannot exchange two-phase piece counts");
+                total = 0;
+                for (p = 0; p < nTasks; p++) {
+                        recvDispls[p] = total;
+                        total += recvCounts[p];
+                }
+                recvMeta = (IOR_offset_t *)realloc(recvMeta, (total + 2)
+                                                   * sizeof(IOR_offset_t));
+                if (recvMeta == NULL)
+                        ERR("realloc() failed");
+                MPI_CHECK(MPI_Alltoallv(sendMeta, sendCounts, sendDispls,
+                                        MPI_LONG_LONG_INT, recvMeta, recvCounts,
+                                        recvDispls, MPI_LONG_LONG_INT, testComm),
+                          "cannot exchange two-phase offsets");
+                nRecv = total / 2;
+
+                /* convert counts from pairs to bytes for the data exchange */
+                for (p = 0; p < nTasks; p++)
+                        sendCounts[p] = 0;
+                for (i = first; i < last; i++)
+                        sendCounts[aggRank[pieces[i].aggregator]] +=
+                                (int)pieces[i].length;
+                for (p = 0, j = 0; p < nTasks; p++) {
+                        nPairs = recvCounts[p] / 2;
+                        recvCounts[p] = 0;
+                        for (; nPairs > 0; nPairs--, j++)
+                                recvCounts[p] += (int)recvMeta[2 * j + 1];
+                }
+                sendDispls[0] = recvDispls[0] = 0;
+                for (p = 1; p < nTasks; p++) {
+                        sendDispls[p] = sendDispls[p - 1] + sendCounts[p - 1];
+                        recvDispls[p] = recvDispls[p - 1] + recvCounts[p - 1];
+                }
+                bytes = sendDispls[nTasks - 1] + sendCounts[nTasks - 1];
+                if ((size_t)bytes > sendDataSize) {
+                        sendData = (char *)realloc(sendData, bytes);
+                        if (sendData == NULL)
+                                ERR("realloc() failed");
+                        sendDataSize = bytes;
+                }
+                bytes = recvDispls[nTasks - 1] + recvCounts[nTasks - 1];
+                if ((size_t)bytes > recvDataSize) {
+                        recvData = (char *)realloc(recvData, bytes);
+                        if (recvData == NULL)
+                                ERR("realloc() failed");
+                        recvDataSize = bytes;
+                }
+
+                /* coalesce received pieces into contiguous runs */
+                if (myAggregator >= 0 && nRecv > 0) {
+                        runs = (IOR_offset_t *)realloc(runs, 2 * nRecv
+                                                       * sizeof(IOR_offset_t));
+                        if (runs == NULL)
+                                ERR("realloc() failed");
+                        memcpy(runs, recvMeta, 2 * nRecv * sizeof(IOR_offset_t));
+                        qsort(runs, nRecv, 2 * sizeof(IOR_offset_t),
+                              TwoPhaseCompareOffsets);
+                        for (i = 1; i < nRecv; i++) {
+                                if (runs[2 * nRuns] + runs[2 * nRuns + 1]
+                                    == runs[2 * i]) {
+                                        runs[2 * nRuns + 1] += runs[2 * i + 1];
+                                } else {
+                                        nRuns++;
+                                        runs[2 * nRuns] = runs[2 * i];
+                                        runs[2 * nRuns + 1] = runs[2 * i + 1];
+                                }
+                        }
+                        nRuns++;
+                }
+                windowStart = globalRange[0] + myAggregator * domainSize
+                              + (IOR_offset_t)round * bufferSize;
+
+                if (access == WRITE) {
+                        /* phase 2: gather data to aggregators, then write */
+                        for (i = first, bytes = 0; i < last; i++) {
+                                if (test->storeFileOffset == TRUE
+                                    && pieces[i].xferOffset != lastFill) {
+                                        FillBuffer(buffer, test,
+                                                   pieces[i].xferOffset,
+                                                   pretendRank);
+                                        lastFill = pieces[i].xferOffset;
+                                }
+                                memcpy(sendData + bytes, buffer
+                                       + (pieces[i].offset - pieces[i].xferOffset),
+                                       pieces[i].length);
+                                bytes += pieces[i].length;
+                        }
+                        MPI_CHECK(MPI_Alltoallv(sendData, sendCounts, sendDispls,
+                                                MPI_BYTE, recvData, recvCounts,
+                                                recvDispls, MPI_BYTE, testComm),
+                                  "cannot exchange two-phase data");
+                        for (i = 0, bytes = 0; i < nRecv; i++) {
+                                memcpy(collBuffer + (recvMeta[2 * i] - windowStart),
+                                       recvData + bytes, recvMeta[2 * i + 1]);
+                                bytes += recvMeta[2 * i + 1];
+                        }
+                        for (i = 0; i < nRuns; i++) {
+                                test->offset = runs[2 * i];
+                                amtXferred = backend->xfer(WRITE, fd,
+                                        (IOR_size_t *)(collBuffer
+                                                       + (runs[2 * i] - windowStart)),
+                                        runs[2 * i + 1], test);
+                                if (amtXferred != runs[2 * i + 1])
+                                        ERR("cannot write to file");
+                        }
+                } else {
+                        /* phase 2: aggregators read, then scatter data */
+                        for (i = 0; i < nRuns; i++) {
+                                test->offset = runs[2 * i];
+                                amtXferred = backend->xfer(READ, fd,
+                                        (IOR_size_t *)(collBuffer
+                                                       + (runs[2 * i] - windowStart)),
+                                        runs[2 * i + 1], test);
+                                if (amtXferred != runs[2 * i + 1])
+                                        ERR("cannot read from file");
+                        }
+                        for (i = 0, bytes = 0; i < nRecv; i++) {
+                                memcpy(recvData + bytes,
+                                       collBuffer + (recvMeta[2 * i] - windowStart),
+                                       recvMeta[2 * i + 1]);
+                                bytes += recvMeta[2 * i + 1];
+                        }
+                        MPI_CHECK(MPI_Alltoallv(recvData, recvCounts, recvDispls,
+                                                MPI_BYTE, sendData, sendCounts,
+                                                sendDispls, MPI_BYTE, testComm),
+                                  "cannot exchange two-phase data");
+                        for (i = first, bytes = 0; i < last; i++) {
+                                memcpy(buffer + (pieces[i].offset
+                                                 - pieces[i].xferOffset),
+                                       sendData + bytes, pieces[i].length);
+                                bytes += pieces[i].length;
+                        }
+                }
+                for (i = first; i < last; i++)
+                        dataMoved += pieces[i].length;
+
+                /* all tasks must agree to stop at the same round */
+                hitStonewall = ((test->deadlineForStonewalling != 0)
+                                && ((GetTimeStamp() - startForStonewall)
+                                    > test->deadlineForStonewalling));
+                if (test->deadlineForStonewalling != 0)
+                        MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &hitStonewall, 1,
+                                                MPI_INT, MPI_MAX, testComm),
+                                  "cannot reduce stonewall flag");
+        }
+
+        if (collBuffer != NULL)
+                aligned_buffer_free(collBuffer);
+        free(sendData);
+        free(recvData);
+        free(recvMeta);
+        free(runs);
+        free(sendMeta);
+        free(sendCounts);
+        free(pieces);
+        free(roundStart);
+        free(aggRank);
+
+        return dataMoved;
+}
+
+/* shared counters handing out transfers when work stealing */
+static struct {
+        MPI_Win window;
+        IOR_offset_t *counter;          /* counter, if this task hosts one */
+        int shards;                     /* number of counters */
+        int homeShard;                  /* shard drained before stealing */
+        int *shardHost;                 /* task hosting each shard's counter */
+        IOR_offset_t transfers;         /* transfers claimed in last phase */
+        IOR_offset_t stolen;            /* of those, owned by another task */
+} workQueue;
+
+/*
+ * Create the work counters.  The transfers of the shared file are split into
+ * one contiguous shard per counter; with workStealingPerNode each node hosts
+ * the counter for its own shard on its first task.
+ */
+static void WorkQueueSetup(IOR_param_t * test)
+{
+        MPI_Comm nodeComm;
+        int *isHost;
+        int i, nodeRank, hosting;
+
+        isHost = (int *)malloc(test->numTasks * sizeof(int));
+        workQueue.shardHost = (int *)malloc(test->numTasks * sizeof(int));
+        workQueue.counter = (IOR_offset_t *)malloc(sizeof(IOR_offset_t));
+        if (isHost == NULL || workQueue.shardHost == NULL
+            || workQueue.counter == NULL)
+                ERR("malloc failed");
+
+        workQueue.shards = 1;
+        workQueue.homeShard = 0;
+        workQueue.shardHost[0] = 0;
+        if (test->workStealingPerNode) {
+                MPI_CHECK(MPI_Comm_split_type(testComm, MPI_COMM_TYPE_SHARED,
+                                              rank, MPI_INFO_NULL, &nodeComm),
+                          "cannot split communicator by node");
+                MPI_CHECK(MPI_Comm_rank(nodeComm, &nodeRank),
+                          "cannot get rank");
+                hosting = (nodeRank == 0);
+                MPI_CHECK(MPI_Allgather(&hosting, 1, MPI_INT, isHost, 1,
+                                        MPI_INT, testComm),
+                          "cannot gather work counter hosts");
+                workQueue.shards = 0;
+                for (i = 0; i < test->numTasks; i++) {
+                        if (isHost[i]) {
+                                if (i == rank)
+                                        workQueue.homeShard = workQueue.shards;
+                                workQueue.shardHost[workQueue.shards++] = i;
+                        }
+                }
+                MPI_CHECK(MPI_Bcast(&workQueue.homeShard, 1, MPI_INT, 0,
+                                    nodeComm),
+                          "cannot broadcast home shard");
+                MPI_CHECK(MPI_Comm_free(&nodeComm), "MPI_Comm_free() error");
+        }
+        free(isHost);
+
+        hosting = (workQueue.shardHost[workQueue.homeShard] == rank);
+        MPI_CHECK(MPI_Win_create(workQueue.counter,
+                                 hosting ? sizeof(IOR_offset_t) : 0,
+                                 sizeof(IOR_offset_t), MPI_INFO_NULL,
+                                 testComm, &workQueue.window),
+                  "cannot create work counter window");
+}
+
+static void WorkQueueFree(void)
+{
+        MPI_CHECK(MPI_Win_free(&workQueue.window),
+                  "cannot free work counter window");
+        free(workQueue.counter);
+        free(workQueue.shardHost);
+}
+
+/*
+ * First transfer index of a shard; shard 'shards' gives the end of the file.
+ */
+static IOR_offset_t WorkQueueShardStart(int shard, IOR_offset_t transfers)
+{
+        return (transfers * shard) / workQueue.shards;
+}
+
+/*
+ * Access the shared file by claiming transfers from the work counters with
+ * MPI_Fetch_and_op() until all are exhausted, draining the home shard before
+ * stealing from the others.  Each transfer index is handed out once, so every
+ * offset is accessed exactly once however the work ends up divided.  Written
+ * data is that of the task owning the offset in the static layout, so the
+ * usual write and read checks verify the result.
+ */
+static IOR_offset_t WorkQueueXfer(IOR_param_t * test, void *fd, int access,
+                                  IOR_io_buffers * ioBuffers)
+{
+        void *buffer = ioBuffers->buffer;
+        IOR_offset_t transfers, index, one = 1;
+        IOR_offset_t amtXferred, dataMoved = 0;
+        IOR_offset_t stripe = test->numTasks * test->blockSize;
+        int shard, exhausted, owner, fillRank = -1;
+        int refill = (test->dataPacketType != incompressible);
+        double startForStonewall;
+        int hitStonewall = FALSE;
+
+        transfers = test->numTasks * test->segmentCount
+                    * (test->blockSize / test->transferSize);
+
+        /* reset counters to the start of their shards */
+        if (workQueue.shardHost[workQueue.homeShard] == rank) {
+                MPI_CHECK(MPI_Win_lock(MPI_LOCK_EXCLUSIVE, rank, 0,
+                                       workQueue.window),
+                          "cannot lock work counter");
+                *workQueue.counter =
+                        WorkQueueShardStart(workQueue.homeShard, transfers);
+                MPI_CHECK(MPI_Win_unlock(rank, workQueue.window),
+                          "cannot unlock work counter");
+        }
+        MPI_CHECK(MPI_Barrier(testComm), "barrier error");
+        MPI_CHECK(MPI_Win_lock_all(0, workQueue.window),
+                  "cannot lock work counters");
+
+        workQueue.transfers = 0;
+        workQueue.stolen = 0;
+        shard = workQueue.homeShard;
+        exhausted = 0;
+        startForStonewall = GetTimeStamp();
+        while (exhausted < workQueue.shards && !hitStonewall) {
+                MPI_CHECK(MPI_Fetch_and_op(&one, &index, MPI_LONG_LONG_INT,
+                                           workQueue.shardHost[shard], 0,
+                                           MPI_SUM, workQueue.window),
+                          "cannot claim transfer");
+                MPI_CHECK(MPI_Win_flush(workQueue.shardHost[shard],
+                                        workQueue.window),
+                          "cannot claim transfer");
+                if (index >= WorkQueueShardStart(shard + 1, transfers)) {
+                        shard = (shard + 1) % workQueue.shards;
+                        exhausted++;
+                        continue;
+                }
+
+                test->offset = index * test->transferSize;
+                owner = (int)((test->offset % stripe) / test->blockSize);
+                if (refill && access == WRITE
+                    && (test->storeFileOffset || owner != fillRank)) {
+                        FillBuffer(buffer, test, test->storeFileOffset ?
+                                   test->offset : 0, owner);
+                        fillRank = owner;
+                }
+                amtXferred = backend->xfer(access, fd, buffer,
+                                           test->transferSize, test);
+                if (amtXferred != test->transferSize)
+                        ERR(access == WRITE ? "cannot write to file"
+                                            : "cannot read from file");
+                dataMoved += amtXferred;
+                workQueue.transfers++;
+                /* stolen from the task the static layout gives it to */
+                if (owner != (rank + rankOffset) % test->numTasks)
+                        workQueue.stolen++;
+
+                hitStonewall = ((test->deadlineForStonewalling != 0)
+                                && ((GetTimeStamp() - startForStonewall)
+                                    > test->deadlineForStonewalling));
+        }
+
+        MPI_CHECK(MPI_Win_unlock_all(workQueue.window),
+                  "cannot unlock work counters");
+
+        /* leave the buffer holding this task's pattern, with this
+           repetition's signature, for the checks; a task may have claimed
+           no transfers, or read over it */
+        if (refill)
+                FillBuffer(buffer, test, 0, (rank + rankOffset) % test->numTasks);
+
+        return dataMoved;
+}
+
+/*
+ * Report how the transfers of the last phase were divided among the tasks.
+ * The aggregate bandwidth reflects what the storage delivered; the spread of
+ * the shares shows how unevenly the clients kept up.
+ */
+static void WorkQueuePrintShare(IOR_param_t * test, double phaseTime,
+                                int access)
+{
+        IOR_offset_t local[2], *all = NULL;
+        IOR_offset_t minShare, maxShare, sumShare = 0, sumStolen = 0;
+        int i;
+
+        local[0] = workQueue.transfers;
+        local[1] = workQueue.stolen;
+        if (rank == 0) {
+                all = (IOR_offset_t *)malloc(2 * test->numTasks
+                                             * sizeof(IOR_offset_t));
+                if (all == NULL)
+                        ERR("malloc failed");
+        }
+        MPI_CHECK(MPI_Gather(local, 2, MPI_LONG_LONG_INT, all, 2,
+                             MPI_LONG_LONG_INT, 0, testComm),
+                  "cannot gather work shares");
+        if (rank != 0)
+                return;
+
+        minShare = maxShare = all[0];
+        for (i = 0; i < test->numTasks; i++) {
+                minShare = MIN(minShare, all[2 * i]);
+                maxShare = MAX(maxShare, all[2 * i]);
+                sumShare += all[2 * i];
+                sumStolen += all[2 * i + 1];
+        }
+        if (verbose >= VERBOSE_0) {
+                fprintf(stdout, "%-10s", access == WRITE ? "write" : "read");
+                fprintf(stdout,
+                        "share: %lld transfers, %lld stolen, per task min %lld mean %.1f max %lld",
+                        sumShare, sumStolen, minShare,
+                        (double)sumShare / test->numTasks, maxShare);
+                if (phaseTime > 0)
+                        fprintf(stdout, ", per task MiB/s min %.2f max %.2f",
+                                (double)minShare * test->transferSize
+                                / MEBIBYTE / phaseTime,
+                                (double)maxShare * test->transferSize
+                                / MEBIBYTE / phaseTime);
+                fprintf(stdout, "\n");
+        }
+        if (verbose >= VERBOSE_2) {
+                for (i = 0; i < test->numTasks; i++)
+                        fprintf(stdout,
+                                "\ttask %d: %lld transfers (%lld stolen)\n",
+                                i, all[2 * i], all[2 * i + 1]);
+        }
+        fflush(stdout);
+        free(all);
+}
+
+/*
+ * Move all of a task's transfers with a single call, the file view
+ * supplying the strides between segments.  The buffer holds every transfer
+ * in view order.  It is filled once per repetition by XferBuffersFill and
+ * only refilled here when each transfer stores its own file offset.
+ */
+static IOR_offset_t StridedDatatypeXfer(IOR_param_t * test, void *fd,
+                                        int access, IOR_io_buffers * ioBuffers,
+                                        IOR_offset_t * offsetArray,
+                                        int pretendRank)
+{
+        char *buffer = (char *)ioBuffers->buffer;
+        char *checkBuffer = (char *)ioBuffers->checkBuffer;
+        IOR_offset_t k, amtXferred;
+        IOR_offset_t length = test->blockSize * test->segmentCount;
+        int errors = 0;
+
+        if (test->storeFileOffset && (access == WRITE || access == WRITECHECK)) {
+                for (k = 0; offsetArray[k] != -1; k++)
+                        FillBuffer(buffer + k * test->transferSize, test,
+                                   offsetArray[k], pretendRank);
+        }
+        test->offset = offsetArray[0];
+        if (access == WRITE) {
+                amtXferred = backend->xfer(access, fd, (IOR_size_t *)buffer,
+                                           length, test);
+                if (amtXferred != length)
+                        ERR("cannot write to file");
+        } else if (access == READ) {
+                amtXferred = backend->xfer(access, fd, (IOR_size_t *)buffer,
+                                           length, test);
+                if (amtXferred != length)
+                        ERR("cannot read from file");
+        } else {
+                memset(checkBuffer, 'a', length);
+                amtXferred = backend->xfer(access, fd,
+                                           (IOR_size_t *)checkBuffer,
+                                           length, test);
+                if (amtXferred != length)
+                        ERR("cannot read from file write check");
+                errors += CompareBuffers(buffer, checkBuffer, length, 1,
+                                         test, WRITECHECK);
+        }
+        totalErrorCount += CountErrors(test, access, errors);
+
+        return (amtXferred);
+}
+
+/*
+ * Collective MPIIO with random offsets.  Tasks hold different numbers of
+ * random transfers, so they are accessed in rounds every task joins: in
+ * each round a task sorts up to randomBatch of its offsets and accesses
+ * them in one collective call through an hindexed file view.  Random
+ * offsets are refused with storeFileOffset and checkRead, so every transfer
+ * of a batch has the same contents and only a write check compares them.
+ */
+static IOR_offset_t RandomBatchXfer(IOR_param_t * test, void *fd,
+                                    int access, IOR_io_buffers * ioBuffers,
+                                    IOR_offset_t * offsetArray)
+{
+#ifdef USE_MPIIO_AIORI
+        char *batchBuffer;
+        IOR_offset_t offsets, rounds, maxRounds, round, i, count;
+        IOR_offset_t dataMoved = 0, amtXferred;
+        IOR_offset_t *batch;
+        int errors = 0;
+
+        if (test->storeFileOffset || access == READCHECK)
+                ERR("collective random rounds neither store offsets nor read check");
+        for (offsets = 0; offsetArray[offsets] != -1; offsets++) ;
+        rounds = (offsets + test->randomBatch - 1) / test->randomBatch;
+        MPI_CHECK(MPI_Allreduce(&rounds, &maxRounds, 1, MPI_LONG_LONG_INT,
+                                MPI_MAX, test->filePerProc ? MPI_COMM_SELF
+                                                           : fileComm),
+                  "cannot agree on random rounds");
+
+        batch = (IOR_offset_t *)malloc(test->randomBatch
+                                       * sizeof(IOR_offset_t));
+        if (batch == NULL)
+                ERR("malloc failed");
+        batchBuffer = aligned_buffer_alloc(test->randomBatch
+                                           * test->transferSize);
+        for (i = 0; i < test->randomBatch; i++) {
+                if (access == WRITE)
+                        memcpy(batchBuffer + i * test->transferSize,
+                               ioBuffers->buffer, test->transferSize);
+                else
+                        memset(batchBuffer + i * test->transferSize, 'a',
+                               test->transferSize);
+        }
+
+        for (round = 0; round < maxRounds; round++) {
+                count = MAX(0, MIN(test->randomBatch,
+                                   offsets - round * test->randomBatch));
+                for (i = 0; i < count; i++)
+                        batch[i] = offsetArray[round * test->randomBatch + i];
+                qsort(batch, count, sizeof(IOR_offset_t),
+                      TwoPhaseCompareOffsets);
+                amtXferred = MPIIO_XferBatch(access, fd,
+                                             (IOR_size_t *)batchBuffer,
+                                             batch, (int)count, test);
+                if (amtXferred != count * test->transferSize)
+                        ERR(access == WRITE ? "cannot write to file"
+                                            : "cannot read from file");
+                if (access == WRITECHECK) {
+                        for (i = 0; i < count; i++) {
+                                test->offset = batch[i];
+                                errors += CompareBuffers(ioBuffers->buffer,
+                                        batchBuffer + i * test->transferSize,
+                                        test->transferSize,
+                                        round * test->randomBatch + i + 1,
+                                        test, WRITECHECK);
+                        }
+                }
+                dataMoved += amtXferred;
+        }
+        totalErrorCount += CountErrors(test, access, errors);
+        aligned_buffer_free(batchBuffer);
+        free(batch);
+
+        return (dataMoved);
+#else
+        ERR("collective random rounds require MPIIO");
+        return (0);
+#endif /* USE_MPIIO_AIORI */
+}
+
+/*
+ * Unordered shared-pointer appends may land at any offset.  Each is stamped
+ * with its writer and the slot it would have had in rank order, k*tasks +
+ * writer; fill the buffer with the contents that stamp implies and return
+ * the slot, or -1 if the stamp is not one of this repetition's.
+ */
+static IOR_offset_t SharedPointerExpected(void *buffer, void *checkBuffer,
+                                          IOR_param_t * test)
+{
+        unsigned long long *data = (unsigned long long *)checkBuffer;
+        unsigned long long writer = data[0] >> 32;
+        unsigned long long offset = data[1] - sizeof(unsigned long long);
+        IOR_offset_t slot = (IOR_offset_t)(offset / test->transferSize);
+        int tasks = test->filePerProc ? 1 : test->numTasks;
+
+        if ((data[0] & 0xffffffffULL) != test->timeStampSignatureValue
+            || writer >= (unsigned long long)test->numTasks
+            || offset % test->transferSize != 0
+            || slot >= (test->blockSize / test->transferSize)
+                       * test->segmentCount * tasks
+            || (!test->filePerProc && slot % tasks != (IOR_offset_t)writer))
+                return (-1);
+        FillBuffer(buffer, test, offset, (int)writer);
+        return (slot);
+}
+
+/*
+ * Check that every slot of the unordered appends was read back exactly once
+ * over all tasks sharing the file, so none was lost or written twice.
+ */
+static int SharedPointerCheckSlots(IOR_param_t * test, int *slots,
+                                   IOR_offset_t count)
+{
+        IOR_offset_t i, lost = 0, doubled = 0;
+        int *all = slots;
+
+        if (!test->filePerProc) {
+                all = (int *)malloc(count * sizeof(int));
+                if (all == NULL)
+                        ERR("malloc failed");
+                MPI_CHECK(MPI_Reduce(slots, all, count, MPI_INT, MPI_SUM, 0,
+                                     testComm), "cannot reduce appends");
+        }
+        if (rank == 0 || test->filePerProc) {
+                for (i = 0; i < count; i++) {
+                        if (all[i] == 0)
+                                lost++;
+                        else if (all[i] > 1)
+                                doubled += all[i] - 1;
+                }
+        }
+        if (all != slots)
+                free(all);
+        if (lost + doubled > 0)
+                fprintf(stdout, "[%d] FAILED shared-pointer appends: %lld "
+                        "lost, %lld duplicated\n", rank, lost, doubled);
+        return ((int)(lost + doubled));
+}
+
+static int CompareHashes(const void *a, const void *b)
+{
+        unsigned long long x = *(const unsigned long long *)a;
+        unsigned long long y = *(const unsigned long long *)b;
+
+        return (x > y) - (x < y);
+}
+
+/*
+ * Measure the compression and dedup ratios of the tunable data of the first
+ * task, over up to 256 MiB of it.  Each block is compressed on its own, as a
+ * block-compressing file system would, and duplicates are found by hash.
+ */
+static void DataRatioEstimate(IOR_param_t * test)
+{
+        IOR_offset_t taskBytes, offset, i;
+        unsigned long long *hashes, h;
+        long long blocks, unique, n = 0;
+        double physical = 0;
+        unsigned char *buffer, *p;
+        IOR_param_t params = *test;
+#if defined(HAVE_ZLIB_H) && defined(HAVE_LIBZ)
+        uLongf destLen, bound = compressBound(test->dedupBlockSize);
+        Bytef *dest = (Bytef *)malloc(bound);
+
+        if (dest == NULL)
+                ERR("malloc failed");
+#endif
+
+        taskBytes = test->blockSize * test->segmentCount;
+        taskBytes = MIN(taskBytes, (IOR_offset_t)256 * MEBIBYTE);
+        taskBytes -= taskBytes % test->transferSize;
+        if (taskBytes == 0)
+                taskBytes = test->transferSize;
+        blocks = taskBytes / test->dedupBlockSize;
+        buffer = (unsigned char *)malloc(test->transferSize);
+        hashes = (unsigned long long *)malloc(blocks * sizeof(unsigned long long));
+        if (buffer == NULL || hashes == NULL)
+                ERR("malloc failed");
+
+        for (offset = 0; offset < taskBytes; offset += test->transferSize) {
+                FillTunableBuffer(buffer, &params, offset, 0);
+                for (i = 0; i < test->transferSize; i += test->dedupBlockSize) {
+                        /* FNV-1a */
+                        h = 0xcbf29ce484222325ULL;
+                        for (p = buffer + i; p < buffer + i + test->dedupBlockSize; p++)
+                                h = (h ^ *p) * 0x100000001b3ULL;
+                        hashes[n++] = h;
+#if defined(HAVE_ZLIB_H) && defined(HAVE_LIBZ)
+                        destLen = bound;
+                        if (compress2(dest, &destLen, buffer + i,
+                                      test->dedupBlockSize, 1) != Z_OK)
+                                ERR("cannot compress data sample");
+                        /* a block that does not shrink is stored as is */
+                        physical += MIN(destLen, test->dedupBlockSize);
+#endif
+                }
+        }
+
+        qsort(hashes, blocks, sizeof(unsigned long long), CompareHashes);
+        for (unique = 1, i = 1; i < blocks; i++)
+                if (hashes[i] != hashes[i - 1])
+                        unique++;
+
+        fprintf(stdout, "data:      over %lld %lld-byte blocks of task 0, dedup %.2f:1",
+                blocks, test->dedupBlockSize, (double)blocks / unique);
+#if defined(HAVE_ZLIB_H) && defined(HAVE_LIBZ)
+        fprintf(stdout, ", compress %.2f:1 (zlib -1)\n",
+                (double)taskBytes / physical);
+        free(dest);
+#else
+        fprintf(stdout, ", compress not measured (built without zlib)\n");
+#endif
+        fflush(stdout);
+        free(hashes);
+        free(buffer);
+}
+
+/*
+ * Report the time tasks spent in shared-file-pointer calls, and how much of
+ * it went to maintaining the pointer rather than moving data.  The pointer
+ * cost is estimated from zero-byte calls made after the timed phase.
+ */
+static void SharedPointerPrintCost(IOR_param_t * test, char *testFileName,
+                                   double phaseTime, int access)
+{
+#ifdef USE_MPIIO_AIORI
+        IOR_offset_t calls, maxCalls;
+        double callTime, probeTime, local[3], max[3];
+
+        probeTime = MPIIO_SharedPointerCost(test, testFileName, access,
+                                            &calls, &callTime);
+        local[0] = callTime;
+        local[1] = MIN(calls * probeTime, callTime);
+        local[2] = phaseTime;
+        MPI_CHECK(MPI_Reduce(local, max, 3, MPI_DOUBLE, MPI_MAX, 0, testComm),
+                  "cannot reduce shared pointer times");
+        MPI_CHECK(MPI_Reduce(&calls, &maxCalls, 1, MPI_LONG_LONG_INT, MPI_MAX,
+                             0, testComm),
+                  "cannot reduce shared pointer calls");
+        if (rank != 0 || verbose < VERBOSE_0)
+                return;
+        fprintf(stdout, "%-10s", access == WRITE ? "write" : "read");
+        fprintf(stdout,
+                "shared pointer: %lld calls, %.6f s in calls, pointer %.6f s (%.1f%% of phase), data %.6f s\n",
+                maxCalls, max[0], max[1],
+                max[2] > 0 ? 100.0 * max[1] / max[2] : 0.0, max[0] - max[1]);
+        fflush(stdout);
+#endif /* USE_MPIIO_AIORI */
+}
+
+/*
+ * A helper thread that fills the buffer of the next transfer, or verifies
+ * the previous one, while the main thread moves data.  One job is posted at
+ * a time; the helper works on its own copy of the test parameters and does
+ * no MPI calls.
+ */
+static struct {
+        pthread_t thread;
+        pthread_mutex_t lock;
+        pthread_cond_t posted;
+        pthread_cond_t done;
+        int pending;                    /* a job is posted, not yet done */
+        int quit;
+        /* the job */
+        void *buffer;                   /* to fill, or the expected data */
+        void *checkBuffer;              /* data read back, to verify */
+        int fill;
+        IOR_offset_t offset;
+        IOR_offset_t transferCount;
+        int fillRank;
+        IOR_param_t params;
+        int errors;
+        double blocked;                 /* main thread waiting on helper */
+        double busy;                    /* helper working */
+} pipeline;
+
+static void *PipelineHelper(void *arg)
+{
+        double start;
+
+        (void)arg;
+
+        pthread_mutex_lock(&pipeline.lock);
+        for (;;) {
+                while (!pipeline.pending && !pipeline.quit)
+                        pthread_cond_wait(&pipeline.posted, &pipeline.lock);
+                if (!pipeline.pending)
+                        break;
+                pthread_mutex_unlock(&pipeline.lock);
+
+                start = GetTimeStamp();
+                pipeline.params.offset = pipeline.offset;
+                if (pipeline.fill)
+                        FillBuffer(pipeline.buffer, &pipeline.params,
+                                   pipeline.offset, pipeline.fillRank);
+                if (pipeline.checkBuffer != NULL)
+                        pipeline.errors +=
+                                CompareBuffers(pipeline.buffer,
+                                               pipeline.checkBuffer,
+                                               pipeline.params.transferSize,
+                                               pipeline.transferCount,
+                                               &pipeline.params, WRITECHECK);
+                pipeline.busy += GetTimeStamp() - start;
+
+                pthread_mutex_lock(&pipeline.lock);
+                pipeline.pending = FALSE;
+                pthread_cond_signal(&pipeline.done);
+        }
+        pthread_mutex_unlock(&pipeline.lock);
+        return NULL;
+}
+
+/*
+ * Wait for the posted job, if any, counting the time blocked.
+ */
+static void PipelineWait(void)
+{
+        double start = GetTimeStamp();
+
+        pthread_mutex_lock(&pipeline.lock);
+        while (pipeline.pending)
+                pthread_cond_wait(&pipeline.done, &pipeline.lock);
+        pthread_mutex_unlock(&pipeline.lock);
+        pipeline.blocked += GetTimeStamp() - start;
+}
+
+/*
+ * Post a job: fill 'buffer' for the transfer at 'offset' if 'fill', then
+ * verify 'checkBuffer' against it unless that is NULL.
+ */
+static void PipelinePost(void *buffer, void *checkBuffer, int fill,
+                         IOR_offset_t offset, IOR_offset_t transferCount,
+                         int fillRank)
+{
+        PipelineWait();
+        pthread_mutex_lock(&pipeline.lock);
+        pipeline.buffer = buffer;
+        pipeline.checkBuffer = checkBuffer;
+        pipeline.fill = fill;
+        pipeline.offset = offset;
+        pipeline.transferCount = transferCount;
+        pipeline.fillRank = fillRank;
+        pipeline.pending = TRUE;
+        pthread_cond_signal(&pipeline.posted);
+        pthread_mutex_unlock(&pipeline.lock);
+}
+
+static void PipelineStart(IOR_param_t *test)
+{
+        pipeline.params = *test;
+        pipeline.pending = FALSE;
+        pipeline.quit = FALSE;
+        pipeline.errors = 0;
+        pipeline.blocked = 0.0;
+        pipeline.busy = 0.0;
+        pthread_mutex_init(&pipeline.lock, NULL);
+        pthread_cond_init(&pipeline.posted, NULL);
+        pthread_cond_init(&pipeline.done, NULL);
+        if (pthread_create(&pipeline.thread, NULL, PipelineHelper, NULL) != 0)
+                ERR("cannot start fill pipeline thread");
+}
+
+/*
+ * Finish the last job and stop the helper.  Returns the errors it found.
+ */
+static int PipelineStop(IOR_param_t *test)
+{
+        PipelineWait();
+        pthread_mutex_lock(&pipeline.lock);
+        pipeline.quit = TRUE;
+        pthread_cond_signal(&pipeline.posted);
+        pthread_mutex_unlock(&pipeline.lock);
+        pthread_join(pipeline.thread, NULL);
+        pthread_mutex_destroy(&pipeline.lock);
+        pthread_cond_destroy(&pipeline.posted);
+        pthread_cond_destroy(&pipeline.done);
+        /* the helper's fills advance the incompressible data sequence */
+        test->incompressibleSeed = pipeline.params.incompressibleSeed;
+        return pipeline.errors;
+}
+
+/*
+ * Report the time tasks were blocked on the fill pipeline in a phase.
+ */
+static void PipelinePrintBlocked(double phaseTime, int access)
+{
+        double local[2], max[2];
+
+        local[0] = pipeline.blocked;
+        local[1] = pipeline.busy;
+        MPI_CHECK(MPI_Reduce(local, max, 2, MPI_DOUBLE, MPI_MAX, 0, testComm),
+                  "cannot reduce pipeline times");
+        if (rank != 0 || verbose < VERBOSE_0)
+                return;
+        fprintf(stdout, "pipeline: %s blocked %.6f s (%.1f%% of phase), "
+                "helper busy %.6f s (max over tasks)\n",
+                access == WRITE ? "write" : "check", max[0],
+                phaseTime > 0 ? 100.0 * max[0] / phaseTime : 0.0, max[1]);
+}
+
+/*
+ * Report the bytes a compressed phase moved before and after compression, and
+ * the CPU time spent compressing or decompressing them.
+ */
+static void CompressPrintStats(double phaseTime, int access)
+{
+        IOR_offset_t local[2], sum[2];
+        double localTime[2], max[2];
+
+        COMPRESS_Stats(&local[0], &local[1], &localTime[0]);
+        localTime[1] = phaseTime;
+        MPI_CHECK(MPI_Reduce(local, sum, 2, MPI_LONG_LONG_INT, MPI_SUM, 0,
+                             testComm), "cannot reduce compressed bytes");
+        MPI_CHECK(MPI_Reduce(localTime, max, 2, MPI_DOUBLE, MPI_MAX, 0,
+                             testComm), "cannot reduce compression times");
+        if (rank != 0 || verbose < VERBOSE_0)
+                return;
+        fprintf(stdout, "compress: %s %.2f MiB/s logical, %.2f MiB/s physical, "
+                "ratio %.2f:1, cpu %.6f s (max over tasks)\n",
+                access == WRITE ? "write" : "read",
+                max[1] > 0 ? (double)sum[0] / MEBIBYTE / max[1] : 0.0,
+                max[1] > 0 ? (double)sum[1] / MEBIBYTE / max[1] : 0.0,
+                sum[1] > 0 ? (double)sum[0] / sum[1] : 0.0, max[0]);
+}
+
+/*
+ * Report the transfers a phase made against the memory backend, where the
+ * cost of an operation is IOR's own with at most a memcpy.
+ */
+static void MemPrintOps(IOR_param_t *test, double phaseTime, int access)
+{
+#ifdef USE_MEM_AIORI
+        IOR_offset_t local, sum;
+        double max;
+
+        local = MEM_Ops();
+        MPI_CHECK(MPI_Reduce(&local, &sum, 1, MPI_LONG_LONG_INT, MPI_SUM, 0,
+                             testComm), "cannot reduce operation counts");
+        MPI_CHECK(MPI_Reduce(&phaseTime, &max, 1, MPI_DOUBLE, MPI_MAX, 0,
+                             testComm), "cannot reduce phase times");
+        if (rank != 0 || verbose < VERBOSE_0)
+                return;
+        fprintf(stdout, "mem:      %s %lld ops, %.0f ops/s, %.3f us per op "
+                "per task\n", access == WRITE ? "write" : "read", sum,
+                max > 0 ? sum / max : 0.0,
+                sum > 0 ? 1.0e6 * max * test->numTasks / sum : 0.0);
+#endif
+}
+
+/*
+ * Paced transfers.  Open loop issues each transfer at a Poisson arrival
+ * time, whether or not the previous one has finished; closed loop issues it
+ * an exponentially distributed think time after the previous one finishes.
+ * Latency is timed from when a transfer was due, not from when it could be
+ * issued, so a stall is charged to every transfer it delays.
+ */
+static struct {
+        double interval;                /* mean time between transfers */
+        double due;                     /* when the next transfer is due */
+        unsigned int seed;
+        long long hist[PACE_BUCKETS];
+        double max;
+} pace;
+
+static void SleepFor(double seconds)
+{
+        struct timespec ts;
+
+        ts.tv_sec = (time_t)seconds;
+        ts.tv_nsec = (long)((seconds - ts.tv_sec) * 1.0e9);
+        while (nanosleep(&ts, &ts) != 0)
+                if (errno != EINTR)
+                        ERR("nanosleep() failed");
+}
+
+static double PaceInterval(IOR_param_t *test)
+{
+        double rate = test->paceRate;
+
+        if (test->paceBandwidth > 0)
+                rate = (double)test->paceBandwidth / test->transferSize;
+        if (test->paceAggregate)
+                rate /= test->numTasks;
+        return (1.0 / rate);
+}
+
+static double PaceExponential(void)
+{
+        double u = rand_r(&pace.seed) / ((double)RAND_MAX + 1);
+
+        return (-log(1.0 - u) * pace.interval);
+}
+
+static void PaceStart(IOR_param_t *test)
+{
+        memset(&pace, 0, sizeof(pace));
+        pace.interval = PaceInterval(test);
+        pace.seed = (test->randomSeed > 0 ? test->randomSeed : 1) + rank;
+        pace.due = MPI_Wtime();
+        if (test->paceLoop == pace_open)
+                pace.due += PaceExponential();
+}
+
+/*
+ * Wait until the next transfer is due and return when that was.  Waits
+ * shorter than a scheduler tick are spun out.
+ */
+static double PaceWait(IOR_param_t *test)
+{
+        double due = pace.due;
+        double wait = due - MPI_Wtime();
+
+        if (wait > 1.0e-4)
+                SleepFor(wait - 1.0e-4);
+        while (MPI_Wtime() < due)
+                ;
+        if (test->paceLoop == pace_open)
+                pace.due += PaceExponential();
+        return (due);
+}
+
+static void PaceDone(IOR_param_t *test, double due)
+{
+        double now = MPI_Wtime();
+        double latency = now - due;
+        int bucket = 0;
+
+        if (latency > 1.0e-6)
+                bucket = (int)(PACE_PER_OCTAVE * log2(latency / 1.0e-6));
+        if (bucket >= PACE_BUCKETS)
+                bucket = PACE_BUCKETS - 1;
+        pace.hist[bucket]++;
+        if (latency > pace.max)
+                pace.max = latency;
+        if (test->paceLoop == pace_closed)
+                pace.due = now + PaceExponential();
+}
+
+/*
+ * Latency below which a fraction of the histogram's transfers completed, as
+ * the upper edge of its bucket, but no more than the longest latency 'max'.
+ */
+static double PaceQuantile(long long *hist, double fraction, double max)
+{
+        long long total = 0, sum = 0;
+        int i;
+
+        for (i = 0; i < PACE_BUCKETS; i++)
+                total += hist[i];
+        for (i = 0; i < PACE_BUCKETS; i++) {
+                sum += hist[i];
+                if (sum > 0 && sum >= fraction * total)
+                        break;
+        }
+        return (MIN(max, 1.0e-6 * pow(2.0, (double)(i + 1) / PACE_PER_OCTAVE)));
+}
+
+/*
+ * Report the offered and achieved rate of a paced phase and its latency
+ * distribution over all tasks, and add it to the test's histogram.
+ */
+static void PacePrint(IOR_test_t *test, double phaseTime, int access)
+{
+        IOR_param_t *params = &test->params;
+        long long hist[PACE_BUCKETS], *testHist, ops = 0;
+        double max[2], local[2];
+        int i;
+
+        local[0] = pace.max;
+        local[1] = phaseTime;
+        MPI_CHECK(MPI_Reduce(pace.hist, hist, PACE_BUCKETS, MPI_LONG_LONG_INT,
+                             MPI_SUM, 0, testComm),
+                  "cannot reduce latency histogram");
+        MPI_CHECK(MPI_Reduce(local, max, 2, MPI_DOUBLE, MPI_MAX, 0, testComm),
+                  "cannot reduce latencies");
+        if (rank != 0)
+                return;
+        testHist = test->results->paceHist
+                   + (access == WRITE ? 0 : PACE_BUCKETS);
+        for (i = 0; i < PACE_BUCKETS; i++)
+                testHist[i] += hist[i];
+        i = (access == WRITE ? 0 : 1);
+        test->results->paceMax[i] = MAX(test->results->paceMax[i], max[0]);
+        if (verbose < VERBOSE_0)
+                return;
+
+        for (i = 0; i < PACE_BUCKETS; i++)
+                ops += hist[i];
+        fprintf(stdout, "pace:     %s ", access == WRITE ? "write" : "read");
+        if (params->paceLoop == pace_open)
+                fprintf(stdout, "offered %.1f ops/s, ",
+                        params->numTasks / pace.interval);
+        else
+                fprintf(stdout, "closed loop, think %.6f s, ", pace.interval);
+        fprintf(stdout, "achieved %.1f ops/s, latency(us) p50 %.1f p90 %.1f "
+                "p99 %.1f p99.9 %.1f max %.1f\n",
+                max[1] > 0 ? ops / max[1] : 0.0,
+                1.0e6 * PaceQuantile(hist, 0.5, max[0]),
+                1.0e6 * PaceQuantile(hist, 0.9, max[0]),
+                1.0e6 * PaceQuantile(hist, 0.99, max[0]),
+                1.0e6 * PaceQuantile(hist, 0.999, max[0]), 1.0e6 * max[0]);
+}
+
+/*
+ * Write or Read data to file(s).  This loops through the strides, writing
+ * out the data to each block in transfer sizes, until the remainder left is 0.
+ */
+static IOR_offset_t WriteOrRead(IOR_param_t * test, void *fd, int access, IOR_io_buffers* ioBuffers)
+{
+        int errors = 0;
+        IOR_offset_t amtXferred;
+        IOR_offset_t transfer;
+        IOR_offset_t transferCount = 0;
+        IOR_offset_t pairCnt = 0;
+        IOR_offset_t *offsetArray;
+        int *virtualOwner = NULL;
+        int *writerOwner = NULL;
+        int pretendRank, fillRank, filledRank = -1;
+        void *buffer = ioBuffers->buffer;
         void *checkBuffer = ioBuffers->checkBuffer;
         void *readCheckBuffer = ioBuffers->readCheckBuffer;
+        char *check;
         IOR_offset_t dataMoved = 0;     /* for data rate calculation */
-        double startForStonewall;
-        int hitStonewall;
+        double startForStonewall, due = 0;
+        int *slots = NULL;              /* unordered appends read back */
+        IOR_offset_t slot, slotCount = 0;
+        int hitStonewall, pipelined, paced, bursty;
+        IOR_offset_t perBurst = 0;
+
+        /* compression is reported per write or read phase */
+        if (test->compressor[0] != '\0' && (access == WRITE || access == READ))
+                COMPRESS_StatsReset();
+#ifdef USE_MEM_AIORI
+        if (strcmp(test->api, "MEM") == 0 && (access == WRITE || access == READ))
+                MEM_OpsReset();
+#endif
 
         /* initialize values */
         pretendRank = (rank + rankOffset) % test->numTasks;
-
-        if (test->randomOffset) {
+        fillRank = pretendRank;
+
+        if (test->writerTasks > 0) {
+                offsetArray = GetOffsetArrayRestart(test, pretendRank, access,
+                                                    &writerOwner);
+        } else if (test->useSharedFilePointer) {
+                offsetArray = GetOffsetArraySharedPointer(test, pretendRank);
+        } else if (test->subarrayDims > 0) {
+                offsetArray = GetOffsetArraySubarray(test, pretendRank);
+        } else if (test->virtualRanks > 1) {
+                offsetArray = GetOffsetArrayVirtual(test, pretendRank, access,
+                                                    &virtualOwner);
+        } else if (test->randomOffset) {
                 offsetArray = GetOffsetArrayRandom(test, pretendRank, access);
         } else {
                 offsetArray = GetOffsetArraySequential(test, pretendRank);
         }
 
 
+        /* two-phase I/O handles the whole timed phase collectively */
+        if (test->twoPhase && (access == WRITE || access == READ)) {
+                dataMoved = TwoPhaseXfer(test, fd, access, ioBuffers,
+                                         offsetArray, pretendRank);
+                free(offsetArray);
+                if (access == WRITE && test->fsync == TRUE)
+                        backend->fsync(fd, test);
+                return (dataMoved);
+        }
+
+        /* random collective access proceeds in rounds every task joins */
+        if (test->randomOffset && test->collective
+            && strcmp(test->api, "MPIIO") == 0) {
+                dataMoved = RandomBatchXfer(test, fd, access, ioBuffers,
+                                            offsetArray);
+                free(offsetArray);
+                if (access == WRITE && test->fsync == TRUE)
+                        backend->fsync(fd, test);
+                return (dataMoved);
+        }
+
+        /* one call moves all of the task's transfers through the file view */
+        if (test->useStridedDatatype) {
+                dataMoved = StridedDatatypeXfer(test, fd, access, ioBuffers,
+                                                offsetArray, pretendRank);
+                free(offsetArray);
+                if (access == WRITE && test->fsync == TRUE)
+                        backend->fsync(fd, test);
+                return (dataMoved);
+        }
+
+        /* dynamically claimed transfers replace the static offset list */
+        if (test->workStealing && (access == WRITE || access == READ)) {
+                dataMoved = WorkQueueXfer(test, fd, access, ioBuffers);
+                free(offsetArray);
+                if (access == WRITE && test->fsync == TRUE)
+                        backend->fsync(fd, test);
+                return (dataMoved);
+        }
+
         /* check for stonewall */
         startForStonewall = GetTimeStamp();
         hitStonewall = ((test->deadlineForStonewalling != 0)
                         && ((GetTimeStamp() - startForStonewall)
                             > test->deadlineForStonewalling));
 
+        /* the helper fills the first transfer's buffer, then each next one
+           while the current one moves */
+        if (access == WRITECHECK && test->useSharedFilePointer
+            && !test->collective) {
+                slotCount = (test->blockSize / test->transferSize)
+                            * test->segmentCount
+                            * (test->filePerProc ? 1 : test->numTasks);
+                slots = (int *)calloc(slotCount, sizeof(int));
+                if (slots == NULL)
+                        ERR("calloc failed");
+        }
+        pipelined = test->fillPipeline
+                    && (access == WRITE
+                        || (access == WRITECHECK && slots == NULL));
+        if (pipelined) {
+                PipelineStart(test);
+                if (access == WRITE && test->storeFileOffset
+                    && offsetArray[0] != -1)
+                        PipelinePost(buffer, NULL, TRUE, offsetArray[0], 0,
+                                     fillRank);
+        }
+
+        paced = (test->paceRate > 0 || test->paceBandwidth > 0)
+                && (access == WRITE || access == READ);
+        if (paced)
+                PaceStart(test);
+        bursty = test->burstSize > 0 && access == WRITE;
+        if (bursty) {
+                perBurst = test->burstSize / test->transferSize;
+                BurstStart(test);
+        }
+
         /* loop over offsets to access */
         while ((offsetArray[pairCnt] != -1) && !hitStonewall) {
                 test->offset = offsetArray[pairCnt];
+                /* transfers take the pool's buffers in turn, the same ones
+                   when checking */
+                buffer = (char *)ioBuffers->buffer
+                         + (pairCnt % test->bufferPool) * test->transferSize;
+                /* each virtual rank has its own handle and data pattern */
+                if (virtualOwner != NULL) {
+                        fd = virtualFd[virtualOwner[pairCnt]];
+                        fillRank = pretendRank * test->virtualRanks
+                                   + virtualOwner[pairCnt];
+                } else if (writerOwner != NULL) {
+                        /* data is that of the task that wrote the offset */
+                        fillRank = writerOwner[pairCnt];
+                }
                 /*
                  * fills each transfer with a unique pattern
                  * containing the offset into the file
                  */
-                if (test->storeFileOffset == TRUE) {
-                        FillBuffer(buffer, test, test->offset, pretendRank);
+                if (test->storeFileOffset == TRUE && !pipelined) {
+                        FillBuffer(buffer, test, test->offset, fillRank);
+                } else if ((virtualOwner != NULL || writerOwner != NULL)
+                           && access != READ && fillRank != filledRank) {
+                        FillBuffer(buffer, test, 0, fillRank);
+                        filledRank = fillRank;
                 }
                 transfer = test->transferSize;
-                if (access == WRITE) {
+                if (bursty && pairCnt % perBurst == 0)
+                        BurstBegin();
+                if (paced)
+                        due = PaceWait(test);
+                if (access == WRITE && pipelined) {
+                        PipelineWait();
+                        if (test->storeFileOffset
+                            && offsetArray[pairCnt + 1] != -1)
+                                PipelinePost((char *)ioBuffers->buffer
+                                             + ((pairCnt + 1) % test->bufferPool)
+                                             * transfer, NULL, TRUE,
+                                             offsetArray[pairCnt + 1], 0,
+                                             fillRank);
+                        amtXferred =
+                                backend->xfer(access, fd, buffer, transfer, test);
+                        if (amtXferred != transfer)
+                                ERR("cannot write to file");
+                } else if (access == WRITECHECK && pipelined) {
+                        /* read into one check buffer while the helper
+                           verifies the other */
+                        check = (char *)checkBuffer
+                                + (pairCnt % 2) * transfer;
+                        memset(check, 'a', transfer);
+                        amtXferred =
+                                backend->xfer(access, fd, (IOR_size_t *)check,
+                                              transfer, test);
+                        if (amtXferred != transfer)
+                                ERR("cannot read from file write check");
+                        transferCount++;
+                        PipelinePost(buffer, check, test->storeFileOffset,
+                                     test->offset, transferCount, fillRank);
+                } else if (access == WRITE) {
                         amtXferred =
                                 backend->xfer(access, fd, buffer, transfer, test);
                         if (amtXferred != transfer)
@@ -2709,6 +6382,29 @@ static IOR_offset_t WriteOrRead(IOR_param_t * test, void *fd, int access, IOR_io
                                               test);
                         if (amtXferred != transfer)
                                 ERR("cannot read from file write check");
+                        if (slots != NULL) {
+                                slot = SharedPointerExpected(buffer,
+                                                             checkBuffer,
+                                                             test);
+                                if (slot >= 0)
+                                        slots[slot]++;
+                                else    /* compare to this task's own */
+                                        FillBuffer(buffer, test, test->offset,
+                                                   pretendRank);
+                        }
+                        transferCount++;
+                        errors += CompareBuffers(buffer, checkBuffer, transfer,
+                                                 transferCount, test,
+                                                 WRITECHECK);
+                } else if (access == READCHECK && writerOwner != NULL) {
+                        /* tasks read unequal shares, so each checks its
+                           data against the pattern of the task that wrote
+                           it rather than against a neighbor's reread */
+                        memset(checkBuffer, 'a', transfer);
+                        amtXferred = backend->xfer(access, fd, checkBuffer,
+                                                   transfer, test);
+                        if (amtXferred != transfer)
+                                ERR("cannot read from file on read check");
                         transferCount++;
                         errors += CompareBuffers(buffer, checkBuffer, transfer,
                                                  transferCount, test,
@@ -2718,21 +6414,54 @@ static IOR_offset_t WriteOrRead(IOR_param_t * test, void *fd, int access, IOR_io
                                   test, transfer, test->blockSize, &amtXferred,
                                   &transferCount, access, &errors);
                 }
+                if (paced)
+                        PaceDone(test, due);
                 dataMoved += amtXferred;
                 pairCnt++;
+                if (bursty) {
+                        burst.bytes += amtXferred;
+                        if (pairCnt % perBurst == 0
+                            || offsetArray[pairCnt] == -1)
+                                BurstEnd(test);
+                }
 
                 hitStonewall = ((test->deadlineForStonewalling != 0)
                                 && ((GetTimeStamp() - startForStonewall)
                                     > test->deadlineForStonewalling));
         }
 
+#ifdef USE_MPIIO_AIORI
+        /* the phase ends when the last request in flight completes */
+        if (test->nonblockingWindow > 0)
+                MPIIO_Wait(test);
+#endif
+        if (pipelined)
+                errors += PipelineStop(test);
+        if (slots != NULL) {
+                errors += SharedPointerCheckSlots(test, slots, slotCount);
+                free(slots);
+        }
+
         totalErrorCount += CountErrors(test, access, errors);
 
         free(offsetArray);
 
         if (access == WRITE && test->fsync == TRUE) {
-                backend->fsync(fd, test);       /*fsync after all accesses */
+                if (virtualOwner != NULL) {
+                        int k;
+                        for (k = 0; k < test->virtualRanks; k++)
+                                backend->fsync(virtualFd[k], test);
+                } else {
+                        backend->fsync(fd, test);       /*fsync after all accesses */
+                }
         }
+        if (access == WRITECHECK && test->useSharedFilePointer
+            && !test->collective)
+                FillBuffer(buffer, test, 0, pretendRank);
+        if (virtualOwner != NULL)
+                free(virtualOwner);
+        if (writerOwner != NULL)
+                free(writerOwner);
         return (dataMoved);
 }
 
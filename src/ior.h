@@ -47,6 +47,7 @@ extern int rankOffset;
 extern int tasksPerNode;
 extern int verbose;
 extern MPI_Comm testComm;
+extern MPI_Comm fileComm;
 
 
 /******************** DATA Packet Type ***************************************/
@@ -57,11 +58,36 @@ enum PACKET_TYPE
     generic = 0,                /* No packet type specified */
     timestamp=1,                  /* Timestamp packet set with -l */
     offset=2,                     /* Offset packet set with -l */
-    incompressible=3              /* Incompressible packet set with -l */
+    incompressible=3,             /* Incompressible packet set with -l */
+    tunable=4                     /* compressRatio/dedupRatio data */
 
 };
 
 
+/* Holds the page cache state a test reads the file(s) in */
+
+enum CACHE_MODE
+{
+    cache_any = 0,                /* whatever the write left */
+    cache_cold = 1,               /* dropped before reading */
+    cache_warm = 2,               /* pre-read before reading */
+    cache_both = 3,               /* a cold test, then a warm one */
+    cache_direct = 4              /* read through an O_DIRECT re-open */
+};
+
+
+/* How paced transfers are issued */
+
+enum PACE_LOOP
+{
+    pace_open = 0,                /* at Poisson arrival times */
+    pace_closed = 1               /* a think time after each completes */
+};
+
+/* latency histogram buckets: PACE_PER_OCTAVE per doubling from 1 us */
+#define PACE_PER_OCTAVE 8
+#define PACE_BUCKETS    (32 * PACE_PER_OCTAVE)
+
 
 /***************** IOR_BUFFERS *************************************************/
 /* A struct to hold the buffers so we can pass 1 pointer around instead of 3
@@ -96,16 +122,31 @@ typedef struct
     unsigned int openFlags;          /* open flags (see also <open>) */
     int referenceNumber;             /* user supplied reference number */
     char api[MAX_STR];               /* API for I/O */
+    char apiLayers[MAX_STR];         /* layers stacked on the API, "a:b" */
     char apiVersion[MAX_STR];        /* API version */
     char platform[MAX_STR];          /* platform type */
     char testFileName[MAXPATHLEN];   /* full name for test */
     char testFileName_fppReadCheck[MAXPATHLEN];/* filename for fpp read check */
     char hintsFileName[MAXPATHLEN];  /* full name for hints file */
+    char hintSearchFile[MAXPATHLEN]; /* hint values to tune over */
+    char hintTuneFile[MAXPATHLEN];   /* hints file for the tuned values */
     char options[MAXPATHLEN];        /* options string */
     int numTasks;                    /* number of tasks for test */
+    int virtualRanks;                /* logical ranks emulated by each task */
+    int tasksPerFile;                /* tasks sharing each file (0 = all) */
+    int subarrayDims;                /* dimensions of subarray layout (0=off) */
+    int globalDims[3];               /* global array size in elements */
+    int processGrid[3];              /* tasks along each array dimension */
+    int elementSize;                 /* bytes per array element */
+    int writerTasks;                 /* tasks that wrote file, for restart */
+    IOR_offset_t restartBlockSize;   /* restart read block (0 = even split) */
     int nodes;                       /* number of nodes for test */
     int tasksPerNode;                /* number of tasks per node */
     int repetitions;                 /* number of repetitions of test */
+    double ciTarget;                 /* stop at this CI half-width, % of mean */
+    int minRepetitions;              /* fewest reps before stopping on ciTarget */
+    int warmupRepetitions;           /* uncounted reps run first */
+    enum CACHE_MODE cacheMode;       /* page cache state for reads */
     int repCounter;                  /* rep counter */
     int multiFile;                   /* multiple files */
     int interTestDelay;              /* delay between reps in seconds */
@@ -117,6 +158,8 @@ typedef struct
     int taskPerNodeOffset;           /* task node offset for reading files   */
     int reorderTasksRandom;          /* reorder tasks for random file read back */
     int reorderTasksRandomSeed;      /* reorder tasks for random file read seed */
+    int reorderTasksTopology;        /* read back data of another node/rack */
+    char topologyFile[MAXPATHLEN];   /* 'host rack' lines for the above */
     int checkWrite;                  /* check read after write */
     int checkRead;                   /* check read after read */
     int keepFile;                    /* don't delete the testfile on exit */
@@ -124,6 +167,11 @@ typedef struct
     int errorFound;                  /* error found in data check */
     int quitOnError;                 /* quit code when error in check */
     int collective;                  /* collective I/O */
+    int twoPhase;                    /* IOR-level two-phase collective I/O */
+    int twoPhaseAggregators;         /* aggregator count (0 = one per node) */
+    IOR_offset_t twoPhaseBufferSize; /* per-aggregator buffer for each round */
+    int workStealing;                /* claim transfers from a shared counter */
+    int workStealingPerNode;         /* one work counter per node */
     IOR_offset_t segmentCount;       /* number of segments (or HDF5 datasets) */
     IOR_offset_t blockSize;          /* contiguous bytes to write per task */
     IOR_offset_t transferSize;       /* size of transfer in bytes */
@@ -133,6 +181,8 @@ typedef struct
     int useFileView;                 /* use MPI_File_set_view */
     int useSharedFilePointer;        /* use shared file pointer */
     int useStridedDatatype;          /* put strided access into datatype */
+    int nonblockingWindow;           /* MPIIO requests in flight (0=blocking) */
+    int randomBatch;                 /* transfers per task per random round */
     int useO_DIRECT;                 /* use O_DIRECT, bypassing I/O buffers */
     int showHints;                   /* show hints */
     int showHelp;                    /* show options and help */
@@ -152,6 +202,28 @@ typedef struct
     int randomOffset;                /* access is to random offsets */
     size_t memoryPerTask;            /* additional memory used per task */
     size_t memoryPerNode;            /* additional memory used per node */
+    IOR_offset_t hugePages;          /* buffer page size (0 = base, -1 = THP) */
+    char bufferNuma[MAX_STR];        /* buffer NUMA node: local, N or device */
+    int lockBuffers;                 /* mlock() the transfer buffers */
+    int bufferPool;                  /* transfer buffers, used in turn */
+    IOR_offset_t bufferBudget;       /* most memory for the buffer pool */
+    int fillPipeline;                /* fill/verify on a helper thread */
+    double compressRatio;            /* target compression ratio, N:1 */
+    double dedupRatio;               /* target dedup ratio, N:1 */
+    IOR_offset_t dedupBlockSize;     /* granularity of dedup and compression */
+    char compressor[MAX_STR];        /* compress transfers: zlib, lz4, zstd */
+    int compressLevel;               /* compressor level (0 = its default) */
+    double delayLatency;             /* delay layer: seconds added per call */
+    double delayJitter;              /* delay layer: up to this much more */
+    IOR_offset_t throttleBandwidth;  /* throttle layer: bytes/s per task */
+    int memCopy;                     /* MEM backend copies transfers */
+    double paceRate;                 /* transfers/s offered (0 = unpaced) */
+    IOR_offset_t paceBandwidth;      /* or bytes/s offered */
+    int paceAggregate;               /* rates are for all tasks together */
+    enum PACE_LOOP paceLoop;         /* open or closed loop */
+    IOR_offset_t burstSize;          /* bytes per task per write burst */
+    double computeTime;              /* seconds of compute after a burst */
+    int computeBurn;                 /* compute on the hog memory, not sleep */
     enum PACKET_TYPE dataPacketType;             /* The type of data packet.  */
 
 
@@ -207,6 +279,8 @@ typedef struct
                                       creating or opening a file */
 
     int id;                          /* test's unique ID */
+    int sweepId;                     /* script sweep it came from (0 = none) */
+    char sweepLabel[MAX_STR];        /* swept 'option=value' settings */
     int intraTestBarriers;           /* barriers between open/op and op/close */
 } IOR_param_t;
 
@@ -218,6 +292,9 @@ typedef struct {
    IOR_offset_t *aggFileSizeFromStat;
    IOR_offset_t *aggFileSizeFromXfer;
    IOR_offset_t *aggFileSizeForBW;
+   long long *paceHist;          /* paced latencies, write then read buckets,
+                                    over tasks and repetitions (rank 0) */
+   double paceMax[2];            /* longest paced write and read latency */
 } IOR_results_t;
 
 /* define the queuing structure for the test parameters */
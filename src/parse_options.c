@@ -88,7 +88,85 @@ static size_t NodeMemoryStringToBytes(char *size_str)
 static void RecalculateExpectedFileSize(IOR_param_t *params)
 {
 	params->expectedAggFileSize =
-		params->blockSize * params->segmentCount * params->numTasks;
+		params->blockSize * params->segmentCount * params->numTasks
+		* params->virtualRanks;
+	if (params->writerTasks > 0)
+		params->expectedAggFileSize =
+			params->blockSize * params->segmentCount
+			* params->writerTasks;
+}
+
+/*
+ * Parse array dimensions given as, e.g., "256x256x128".  Returns the number
+ * of dimensions.
+ */
+static int ParseDims(char *value, int *dims)
+{
+        char *p = value;
+        int n = 0;
+
+        while (*p != '\0') {
+                if (n == 3)
+                        ERR("at most three dimensions may be given");
+                dims[n++] = (int)strtol(p, &p, 10);
+                if (*p == 'x' || *p == 'X')
+                        p++;
+                else if (*p != '\0')
+                        ERR("dimensions must be given as, e.g., 64x64x64");
+        }
+        return n;
+}
+
+/*
+ * Split an API given as, e.g., "stats:delay:POSIX" into the layers stacked
+ * on it and the API itself.
+ */
+static void ParseApi(IOR_param_t *params, char *value)
+{
+        char *api = strrchr(value, ':');
+
+        if (api == NULL) {
+                params->apiLayers[0] = '\0';
+                strcpy(params->api, value);
+        } else {
+                strncpy(params->apiLayers, value, api - value);
+                params->apiLayers[api - value] = '\0';
+                strcpy(params->api, api + 1);
+        }
+}
+
+/*
+ * Derive block and transfer sizes from a subarray layout.  Each task's block
+ * is its subarray; a transfer is one contiguous run along the last
+ * dimension, or the whole block when accessed through an MPIIO file view.
+ */
+static void SetSubarrayLayout(IOR_param_t *params)
+{
+        IOR_offset_t localElements = 1;
+        int d, local;
+
+        /* fill in any unspecified process grid dimensions */
+        for (d = 0; d < params->subarrayDims; d++)
+                if (params->processGrid[d] == 0)
+                        break;
+        if (d < params->subarrayDims)
+                MPI_CHECK(MPI_Dims_create(params->numTasks,
+                                          params->subarrayDims,
+                                          params->processGrid),
+                          "cannot create process grid");
+        for (d = 0, local = 1; d < params->subarrayDims; d++) {
+                if (params->globalDims[d] <= 0 || params->processGrid[d] <= 0
+                    || params->globalDims[d] % params->processGrid[d] != 0)
+                        ERR("global dimensions must be multiples of the process grid");
+                local = params->globalDims[d] / params->processGrid[d];
+                localElements *= local;
+        }
+        params->blockSize = localElements * params->elementSize;
+        if (params->useFileView && strcasecmp(params->api, "MPIIO") == 0)
+                params->transferSize = params->blockSize;
+        else
+                params->transferSize = (IOR_offset_t)local * params->elementSize;
+        RecalculateExpectedFileSize(params);
 }
 
 /*
@@ -137,6 +215,9 @@ static void CheckRunSettings(IOR_test_t *tests)
                                   "MPI_Comm_size() error");
                         RecalculateExpectedFileSize(params);
                 }
+
+                if (params->subarrayDims > 0)
+                        SetSubarrayLayout(params);
         }
 }
 
@@ -156,7 +237,7 @@ void DecodeDirective(char *line, IOR_param_t *params)
                 MPI_CHECK(MPI_Abort(MPI_COMM_WORLD, -1), "MPI_Abort() error");
         }
         if (strcasecmp(option, "api") == 0) {
-                strcpy(params->api, value);
+                ParseApi(params, value);
         } else if (strcasecmp(option, "refnum") == 0) {
                 params->referenceNumber = atoi(value);
         } else if (strcasecmp(option, "debug") == 0) {
@@ -167,6 +248,10 @@ void DecodeDirective(char *line, IOR_param_t *params)
                 strcpy(params->testFileName, value);
         } else if (strcasecmp(option, "hintsfilename") == 0) {
                 strcpy(params->hintsFileName, value);
+        } else if (strcasecmp(option, "hintsearchfile") == 0) {
+                strcpy(params->hintSearchFile, value);
+        } else if (strcasecmp(option, "hinttunefile") == 0) {
+                strcpy(params->hintTuneFile, value);
         } else if (strcasecmp(option, "deadlineforstonewalling") == 0) {
                 params->deadlineForStonewalling = atoi(value);
         } else if (strcasecmp(option, "maxtimeduration") == 0) {
@@ -177,6 +262,25 @@ void DecodeDirective(char *line, IOR_param_t *params)
                 params->nodes = atoi(value);
         } else if (strcasecmp(option, "repetitions") == 0) {
                 params->repetitions = atoi(value);
+        } else if (strcasecmp(option, "ciTarget") == 0) {
+                params->ciTarget = atof(value);
+        } else if (strcasecmp(option, "minRepetitions") == 0) {
+                params->minRepetitions = atoi(value);
+        } else if (strcasecmp(option, "warmupRepetitions") == 0) {
+                params->warmupRepetitions = atoi(value);
+        } else if (strcasecmp(option, "cacheMode") == 0) {
+                if (strcasecmp(value, "cold") == 0)
+                        params->cacheMode = cache_cold;
+                else if (strcasecmp(value, "warm") == 0)
+                        params->cacheMode = cache_warm;
+                else if (strcasecmp(value, "both") == 0)
+                        params->cacheMode = cache_both;
+                else if (strcasecmp(value, "direct") == 0)
+                        params->cacheMode = cache_direct;
+                else if (strcasecmp(value, "any") == 0)
+                        params->cacheMode = cache_any;
+                else
+                        ERR("cacheMode must be any, cold, warm, both or direct");
         } else if (strcasecmp(option, "intertestdelay") == 0) {
                 params->interTestDelay = atoi(value);
         } else if (strcasecmp(option, "readfile") == 0) {
@@ -193,6 +297,11 @@ void DecodeDirective(char *line, IOR_param_t *params)
                 params->reorderTasksRandom = atoi(value);
         } else if (strcasecmp(option, "reordertasksrandomSeed") == 0) {
                 params->reorderTasksRandomSeed = atoi(value);
+        } else if (strcasecmp(option, "reordertaskstopology") == 0) {
+                params->reorderTasksTopology = atoi(value);
+        } else if (strcasecmp(option, "topologyfile") == 0) {
+                strcpy(params->topologyFile, value);
+                params->reorderTasksTopology = TRUE;
         } else if (strcasecmp(option, "reordertasks") == 0) {
                 /* Backwards compatibility for the "reorderTasks" option.
                    MUST follow the other longer reordertasks checks. */
@@ -233,6 +342,20 @@ void DecodeDirective(char *line, IOR_param_t *params)
                 params->setTimeStampSignature = atoi(value);
         } else if (strcasecmp(option, "collective") == 0) {
                 params->collective = atoi(value);
+        } else if (strcasecmp(option, "twophaseaggregators") == 0) {
+                params->twoPhaseAggregators = atoi(value);
+        } else if (strcasecmp(option, "twophasebuffersize") == 0) {
+                params->twoPhaseBufferSize = StringToBytes(value);
+        } else if (strcasecmp(option, "twophase") == 0) {
+                params->twoPhase = atoi(value);
+        } else if (strcasecmp(option, "workstealingpernode") == 0) {
+                params->workStealingPerNode = atoi(value);
+        } else if (strcasecmp(option, "workstealing") == 0) {
+                params->workStealing = atoi(value);
+        } else if (strcasecmp(option, "randombatch") == 0) {
+                params->randomBatch = atoi(value);
+        } else if (strcasecmp(option, "nonblockingwindow") == 0) {
+                params->nonblockingWindow = atoi(value);
         } else if (strcasecmp(option, "preallocate") == 0) {
                 params->preallocate = atoi(value);
         } else if (strcasecmp(option, "storefileoffset") == 0) {
@@ -265,6 +388,58 @@ void DecodeDirective(char *line, IOR_param_t *params)
         } else if (strcasecmp(option, "memoryPerNode") == 0) {
                 params->memoryPerNode = NodeMemoryStringToBytes(value);
                 params->memoryPerTask = 0;
+        } else if (strcasecmp(option, "hugePages") == 0) {
+                if (strcasecmp(value, "thp") == 0)
+                        params->hugePages = -1;
+                else
+                        params->hugePages = StringToBytes(value);
+        } else if (strcasecmp(option, "bufferNuma") == 0) {
+                strcpy(params->bufferNuma, value);
+        } else if (strcasecmp(option, "lockBuffers") == 0) {
+                params->lockBuffers = atoi(value);
+        } else if (strcasecmp(option, "bufferPool") == 0) {
+                params->bufferPool = atoi(value);
+        } else if (strcasecmp(option, "bufferBudget") == 0) {
+                params->bufferBudget = StringToBytes(value);
+        } else if (strcasecmp(option, "fillPipeline") == 0) {
+                params->fillPipeline = atoi(value);
+        } else if (strcasecmp(option, "compressRatio") == 0) {
+                params->compressRatio = atof(value);
+        } else if (strcasecmp(option, "dedupRatio") == 0) {
+                params->dedupRatio = atof(value);
+        } else if (strcasecmp(option, "dedupBlockSize") == 0) {
+                params->dedupBlockSize = StringToBytes(value);
+        } else if (strcasecmp(option, "compressor") == 0) {
+                strcpy(params->compressor, value);
+        } else if (strcasecmp(option, "compressLevel") == 0) {
+                params->compressLevel = atoi(value);
+        } else if (strcasecmp(option, "delayLatency") == 0) {
+                params->delayLatency = atof(value);
+        } else if (strcasecmp(option, "delayJitter") == 0) {
+                params->delayJitter = atof(value);
+        } else if (strcasecmp(option, "throttleBandwidth") == 0) {
+                params->throttleBandwidth = StringToBytes(value);
+        } else if (strcasecmp(option, "memCopy") == 0) {
+                params->memCopy = atoi(value);
+        } else if (strcasecmp(option, "paceRate") == 0) {
+                params->paceRate = atof(value);
+        } else if (strcasecmp(option, "paceBandwidth") == 0) {
+                params->paceBandwidth = StringToBytes(value);
+        } else if (strcasecmp(option, "paceAggregate") == 0) {
+                params->paceAggregate = atoi(value);
+        } else if (strcasecmp(option, "burstSize") == 0) {
+                params->burstSize = StringToBytes(value);
+        } else if (strcasecmp(option, "computeTime") == 0) {
+                params->computeTime = atof(value);
+        } else if (strcasecmp(option, "computeBurn") == 0) {
+                params->computeBurn = atoi(value);
+        } else if (strcasecmp(option, "paceLoop") == 0) {
+                if (strcasecmp(value, "open") == 0)
+                        params->paceLoop = pace_open;
+                else if (strcasecmp(value, "closed") == 0)
+                        params->paceLoop = pace_closed;
+                else
+                        ERR("paceLoop must be open or closed");
         } else if (strcasecmp(option, "lustrestripecount") == 0) {
 #ifndef HAVE_LUSTRE_LUSTRE_USER_H
                 ERR("ior was not compiled with Lustre support");
@@ -301,6 +476,22 @@ void DecodeDirective(char *line, IOR_param_t *params)
         } else if (strcasecmp(option, "numtasks") == 0) {
                 params->numTasks = atoi(value);
 		RecalculateExpectedFileSize(params);
+        } else if (strcasecmp(option, "globaldims") == 0) {
+                params->subarrayDims = ParseDims(value, params->globalDims);
+        } else if (strcasecmp(option, "processgrid") == 0) {
+                ParseDims(value, params->processGrid);
+        } else if (strcasecmp(option, "elementsize") == 0) {
+                params->elementSize = StringToBytes(value);
+        } else if (strcasecmp(option, "writertasks") == 0) {
+                params->writerTasks = atoi(value);
+		RecalculateExpectedFileSize(params);
+        } else if (strcasecmp(option, "restartblocksize") == 0) {
+                params->restartBlockSize = StringToBytes(value);
+        } else if (strcasecmp(option, "tasksperfile") == 0) {
+                params->tasksPerFile = atoi(value);
+        } else if (strcasecmp(option, "virtualranks") == 0) {
+                params->virtualRanks = atoi(value);
+		RecalculateExpectedFileSize(params);
         } else if (strcasecmp(option, "summaryalways") == 0) {
                 params->summary_every_test = atoi(value);
         } else {
@@ -311,6 +502,81 @@ void DecodeDirective(char *line, IOR_param_t *params)
         }
 }
 
+/*
+ * Expand a sweep specification of comma-separated items into a list of
+ * values.  An item is either a value, or a range 'first..last' stepped by
+ * ':xF' (multiply), ':+S' or ':S' (add), 1 by default; range bounds accept
+ * size suffixes (e.g., '4k..16m:x2').  Returns the number of values, which
+ * the caller frees along with the list.
+ */
+int ExpandSweep(char *spec, char ***values)
+{
+        char copy[MAX_STR], item[MAX_STR];
+        char *start, *end, *range, *step;
+        IOR_offset_t first, last, value, increment;
+        int geometric, count = 0, allocated = 16;
+
+        *values = (char **)malloc(allocated * sizeof(char *));
+        if (*values == NULL)
+                ERR("malloc failed");
+        strncpy(copy, spec, MAX_STR - 1);
+        copy[MAX_STR - 1] = '\0';
+
+        start = copy;
+        do {
+                end = strchr(start, ',');
+                if (end != NULL)
+                        *end = '\0';
+                if (sscanf(start, " %s", item) != 1)
+                        ERR("empty value in sweep");
+                range = strstr(item, "..");
+                if (range == NULL) {
+                        first = last = 0;
+                        increment = 1;
+                        geometric = FALSE;
+                } else {
+                        *range = '\0';
+                        step = strchr(range + 2, ':');
+                        if (step != NULL)
+                                *step++ = '\0';
+                        first = StringToBytes(item);
+                        last = StringToBytes(range + 2);
+                        geometric = (step != NULL && (*step == 'x'
+                                                      || *step == 'X'));
+                        if (step != NULL && (geometric || *step == '+'))
+                                step++;
+                        increment = step != NULL ? StringToBytes(step) : 1;
+                        if (first < 0 || last < first || increment < 1
+                            || (geometric && (increment < 2 || first < 1)))
+                                ERR("invalid range in sweep");
+                }
+                value = first;
+                do {
+                        if (count == allocated) {
+                                allocated *= 2;
+                                *values = (char **)realloc(*values,
+                                                           allocated
+                                                           * sizeof(char *));
+                                if (*values == NULL)
+                                        ERR("realloc failed");
+                        }
+                        (*values)[count] = (char *)malloc(MAX_STR);
+                        if ((*values)[count] == NULL)
+                                ERR("malloc failed");
+                        if (range == NULL)
+                                strcpy((*values)[count], item);
+                        else
+                                sprintf((*values)[count], "%lld", value);
+                        count++;
+                        value = geometric ? value * increment
+                                          : value + increment;
+                } while (range != NULL && value <= last);
+                start = end + 1;
+        } while (end != NULL);
+
+        return (count);
+}
+
 /*
  * Parse a single line, which may contain multiple comma-seperated directives
  */
@@ -355,6 +621,136 @@ int contains_only(char *haystack, char *needle)
         return 1;
 }
 
+#define MAX_SWEEP_AXES 8
+
+/* a directive of a script block given a list or range of values */
+typedef struct {
+        char option[MAX_STR];
+        char **values;
+        int count;
+} sweep_axis_t;
+
+/*
+ * Whether a directive value is a sweep: a list, or a numeric range (so
+ * that paths such as '../file' are not taken for ranges).
+ */
+static int IsSweep(char *value)
+{
+        char *range = strstr(value, "..");
+
+        if (strchr(value, ',') != NULL)
+                return 1;
+        return (range != NULL && range > value && isalnum(range[-1])
+                && isdigit(range[2]));
+}
+
+/*
+ * Parse a script line like ParseLine(), except that values may be sweeps
+ * (e.g., 'transferSize = 4k..16m:x2, numTasks = 64,128,256'): a piece
+ * without '=' continues the previous value's list.  Sweeps are collected in
+ * 'axes' for the block's run, other directives are applied at once.
+ */
+static void ParseScriptLine(char *line, IOR_param_t * params,
+                            sweep_axis_t * axes, int *nAxes)
+{
+        char directive[MAX_STR], option[MAX_STR], value[MAX_STR];
+        char *piece, *next, *src, *dst;
+        int i;
+
+        line[strcspn(line, "#\r\n")] = '\0';
+        piece = line;
+        while (piece != NULL && *piece != '\0') {
+                /* a directive runs up to the next piece holding an '=' */
+                directive[0] = '\0';
+                do {
+                        next = strchr(piece, ',');
+                        if (next != NULL)
+                                *next++ = '\0';
+                        if (directive[0] != '\0')
+                                strcat(directive, ",");
+                        strcat(directive, piece);
+                        piece = next;
+                } while (piece != NULL && strchr(piece, '=') == NULL
+                         && strspn(piece, " \t") != strlen(piece));
+
+                if (sscanf(directive, " %[^= \t] = %[^\r\n]", option,
+                           value) != 2 || !IsSweep(value)) {
+                        DecodeDirective(directive, params);
+                        continue;
+                }
+                for (src = dst = value; *src != '\0'; src++)
+                        if (!isspace(*src))
+                                *dst++ = *src;
+                *dst = '\0';
+                for (i = 0; i < *nAxes; i++)
+                        if (strcasecmp(axes[i].option, option) == 0)
+                                break;
+                if (i == *nAxes) {
+                        if (*nAxes == MAX_SWEEP_AXES)
+                                ERR("too many swept options in a run");
+                        (*nAxes)++;
+                } else {
+                        while (axes[i].count > 0)
+                                free(axes[i].values[--axes[i].count]);
+                        free(axes[i].values);
+                }
+                strcpy(axes[i].option, option);
+                axes[i].count = ExpandSweep(value, &axes[i].values);
+        }
+}
+
+/*
+ * Expand the sweeps of a block into one test per combination, the first
+ * combination reusing 'tail' and the rest queued after it, all with their
+ * results allocated.  The sweeps are then cleared.  Returns the new tail of
+ * the test list.
+ */
+static IOR_test_t *ExpandSweepTests(IOR_test_t * tail, sweep_axis_t * axes,
+                                    int *nAxes, int *test_num)
+{
+        static int sweepId = 0;
+        IOR_param_t base;
+        IOR_test_t *test = tail;
+        char directive[MAX_STR];
+        int combos = 1, c, i, j, k;
+        size_t len;
+
+        for (i = 0; i < *nAxes; i++)
+                combos *= axes[i].count;
+        sweepId++;
+        base = tail->params;
+        for (c = 0; c < combos; c++) {
+                if (c > 0) {
+                        test->next = CreateTest(&base, (*test_num)++);
+                        test = test->next;
+                }
+                test->params.sweepId = sweepId;
+                test->params.sweepLabel[0] = '\0';
+                /* the last axis varies fastest */
+                for (i = *nAxes - 1, j = c; i >= 0; j /= axes[i].count, i--) {
+                        sprintf(directive, "%s=%s", axes[i].option,
+                                axes[i].values[j % axes[i].count]);
+                        DecodeDirective(directive, &test->params);
+                }
+                for (i = 0; i < *nAxes; i++) {
+                        for (j = c, k = *nAxes - 1; k > i; k--)
+                                j /= axes[k].count;
+                        len = strlen(test->params.sweepLabel);
+                        snprintf(test->params.sweepLabel + len, MAX_STR - len,
+                                 "%s%s=%s", i > 0 ? " " : "", axes[i].option,
+                                 axes[i].values[j % axes[i].count]);
+                }
+                AllocResults(test);
+        }
+        for (i = 0; i < *nAxes; i++) {
+                while (axes[i].count > 0)
+                        free(axes[i].values[--axes[i].count]);
+                free(axes[i].values);
+        }
+        *nAxes = 0;
+        return test;
+}
+
 /*
  * Read the configuration script, allocating and filling in the structure of
  * global parameters.
@@ -368,10 +764,15 @@ IOR_test_t *ReadConfigScript(char *scriptName)
         FILE *file;
         IOR_test_t *head = NULL;
         IOR_test_t *tail = NULL;
+        IOR_param_t *last;
+        IOR_param_t unswept;
+        sweep_axis_t axes[MAX_SWEEP_AXES];
+        int nAxes = 0;
 
         /* Initialize the first test */
         head = CreateTest(&initialTestParams, test_num++);
         tail = head;
+        last = &tail->params;
 
         /* open the script */
         file = fopen(scriptName, "r");
@@ -394,26 +795,40 @@ IOR_test_t *ReadConfigScript(char *scriptName)
                 if (sscanf(linebuf, " #%s", empty) == 1)
                         continue;
                 if (contains_only(linebuf, "ior stop")) {
-                        AllocResults(tail);
+                        if (nAxes > 0)
+                                tail = ExpandSweepTests(tail, axes, &nAxes,
+                                                        &test_num);
+                        else
+                                AllocResults(tail);
                         break;
                 } else if (contains_only(linebuf, "run")) {
                         if (runflag) {
                                 /* previous line was a "run" as well
                                    create duplicate test */
-                                tail->next = CreateTest(&tail->params, test_num++);
+                                tail->next = CreateTest(last, test_num++);
                                 tail = tail->next;
                         }
-                        AllocResults(tail);
+                        /* following blocks start from the unswept settings */
+                        last = &tail->params;
+                        if (nAxes > 0) {
+                                unswept = tail->params;
+                                last = &unswept;
+                                tail = ExpandSweepTests(tail, axes, &nAxes,
+                                                        &test_num);
+                        } else {
+                                AllocResults(tail);
+                        }
                         runflag = 1;
                 } else if (runflag) {
                         /* If this directive was preceded by a "run" line, then
                            create and initialize a new test structure */
                         runflag = 0;
-                        tail->next = CreateTest(&tail->params, test_num++);
+                        tail->next = CreateTest(last, test_num++);
                         tail = tail->next;
-                        ParseLine(linebuf, &tail->params);
+                        last = &tail->params;
+                        ParseScriptLine(linebuf, &tail->params, axes, &nAxes);
                 } else {
-                        ParseLine(linebuf, &tail->params);
+                        ParseScriptLine(linebuf, &tail->params, axes, &nAxes);
                 }
         }
 
@@ -445,7 +860,7 @@ IOR_test_t *ParseCommandLine(int argc, char **argv)
         while ((c = getopt(argc, argv, opts)) != -1) {
                 switch (c) {
                 case 'a':
-                        strcpy(initialTestParams.api, optarg);
+                        ParseApi(&initialTestParams, optarg);
                         break;
                 case 'A':
                         initialTestParams.referenceNumber = atoi(optarg);
@@ -16,5 +16,6 @@
 extern IOR_param_t initialTestParams;
 
 IOR_test_t *ParseCommandLine(int argc, char **argv);
+int ExpandSweep(char *spec, char ***values);
 
 #endif  /* !_PARSE_OPTIONS_H */
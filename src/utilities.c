@@ -19,6 +19,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <errno.h>
+#ifdef __linux__
+#  define __USE_GNU               /* O_DIRECT */
+#  include <fcntl.h>
+#  undef __USE_GNU
+#endif                          /* __linux__ */
 #include <fcntl.h>
 #include <math.h>               /* pow() */
 #include <string.h>
@@ -73,6 +78,16 @@ void set_o_direct_flag(int *fd)
         *fd |= O_DIRECT;
 }
 
+/*
+ * Returns TRUE if the open file descriptor fd bypasses the page cache.
+ */
+int has_o_direct_flag(int fd)
+{
+        int flags = fcntl(fd, F_GETFL);
+
+        return O_DIRECT != 0 && flags >= 0 && (flags & O_DIRECT) != 0;
+}
+
 
 /*
  * Returns string containing the current time.
@@ -449,6 +464,21 @@ void SeedRandGen(MPI_Comm testComm)
         srandom(randomSeed);
 }
 
+/*
+ * First global element index, along each dimension, of the subarray owned by
+ * a task.  Tasks are laid out over the process grid in row-major order.
+ */
+void SubarrayStart(IOR_param_t * test, int pretendRank, int *start)
+{
+        int d;
+
+        for (d = test->subarrayDims - 1; d >= 0; d--) {
+                start[d] = (pretendRank % test->processGrid[d])
+                           * (test->globalDims[d] / test->processGrid[d]);
+                pretendRank /= test->processGrid[d];
+        }
+}
+
 /*
  * System info for Windows.
  */
@@ -19,6 +19,7 @@
 #include "ior.h"
 
 void set_o_direct_flag(int *fd);
+int has_o_direct_flag(int fd);
 
 char *CurrentTimeString(void);
 void OutputToRoot(int, MPI_Comm, char *);
@@ -26,6 +27,7 @@ int Regex(char *, char *);
 void ShowFileSystemSize(char *);
 void DumpBuffer(void *, size_t);
 void SeedRandGen(MPI_Comm);
+void SubarrayStart(IOR_param_t *, int, int *);
 void SetHints (MPI_Info *, char *);
 void ShowHints (MPI_Info *);
 
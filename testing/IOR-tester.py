@@ -12,6 +12,7 @@
 import sys
 import os.path
 import string
+import re
 
 # definitions
 RETURN_TOTAL_TESTS	= -1
@@ -39,6 +40,8 @@ class Test:
     ######################
     # default parameters #
     ######################
+    # a test may also give 'expect', a regular expression some line of its
+    # output must match when run on more than one task
     def DefaultTest(self):
 	return {
 	# general
@@ -78,8 +81,8 @@ class Test:
 	# MPIIO
 	    'useFileView':		0,
 	    'preallocate':		0,
-	    'useSharedFilePointer':	0,	# not working yet
-	    'useStridedDatatype':	0,	# not working yet
+	    'useSharedFilePointer':	0,
+	    'useStridedDatatype':	0,
 	# non-POSIX
 	    'showHints':		0,
 	    'collective':		0,
@@ -137,6 +140,68 @@ class Test:
 	      'repetitions':	1}],
 	    [{'debug':		'POSIX repetitions',
 	      'repetitions':	3}],
+	    [{'debug':		'POSIX repetitions adaptive',
+	      'repetitions':	10,
+	      'ciTarget':	20,
+	      'warmupRepetitions':	1}],
+
+            # POSIX, cache mode
+	    [{'debug':		'POSIX cache mode cold and warm',
+	      'repetitions':	2,
+	      'cacheMode':	'both'}],
+	    [{'debug':		'POSIX cache mode direct',
+	      'cacheMode':	'direct'}],
+
+            # POSIX, parameter sweep
+	    [{'debug':		'POSIX sweep',
+	      'transferSize':	'64k..256k:x4',
+	      'filePerProc':	'0,1'}],
+
+            # POSIX, buffer pool
+	    [{'debug':		'POSIX buffer pool',
+	      'bufferPool':	4,
+	      'storeFileOffset':	1}],
+	    [{'debug':		'POSIX buffer pool fill pipeline',
+	      'fillPipeline':	1,
+	      'checkWrite':	1,
+	      'storeFileOffset':	1}],
+
+            # POSIX, transfer buffer placement
+	    [{'debug':		'POSIX huge page buffers',
+	      'hugePages':	'2m'}],
+	    [{'debug':		'POSIX NUMA local locked buffers',
+	      'bufferNuma':	'local',
+	      'lockBuffers':	1}],
+
+            # POSIX, compress and dedup ratio data
+	    [{'debug':		'POSIX compress and dedup ratio data',
+	      'compressRatio':	2.5,
+	      'dedupRatio':	2,
+	      'checkWrite':	1}],
+
+            # POSIX, compressor
+	    [{'debug':		'POSIX compressor',
+	      'compressor':	'zlib',
+	      'compressRatio':	3,
+	      'checkWrite':	1,
+	      'checkRead':	1}],
+
+            # POSIX, stats and delay layers
+	    [{'debug':		'POSIX stats and delay layers',
+	      'api':		'stats:delay:POSIX',
+	      'delayLatency':	0.001}],
+
+            # POSIX, write bursts
+	    [{'debug':		'POSIX write bursts',
+	      'burstSize':	(MEBIBYTE / 2),
+	      'computeTime':	0.5,
+	      'computeBurn':	1,
+	      'memoryPerTask':	(16 * MEBIBYTE)}],
+
+            # POSIX, pacing
+	    [{'debug':		'POSIX paced open loop',
+	      'paceRate':	1000,
+	      'paceLoop':	'open'}],
 
             # POSIX, repetitions random
 	    [{'debug':		'POSIX repetitions random',
@@ -475,7 +540,82 @@ class Test:
 	      'numTasks':	2,
 	      'randomOffset':	1,
 	      'checkRead':	0,
-	      'segmentCount':	3}]
+	      'segmentCount':	3}],
+
+            # POSIX, two-phase collective
+	    [{'debug':		'POSIX two-phase collective',
+	      'collective':	1,
+	      'transferSize':	MEBIBYTE,
+	      'segmentCount':	3}],
+
+	    [{'debug':		'POSIX two-phase collective small buffer',
+	      'collective':	1,
+	      'twoPhaseBufferSize':	100 * KIBIBYTE,
+	      'twoPhaseAggregators':	2,
+	      'storeFileOffset':1}],
+
+	    [{'debug':		'POSIX two-phase collective random',
+	      'collective':	1,
+	      'randomOffset':	1,
+	      'checkRead':	0}],
+
+            # POSIX, work stealing
+	    [{'debug':		'POSIX work stealing',
+	      'workStealing':	1,
+	      'storeFileOffset':1}],
+
+	    [{'debug':		'POSIX work stealing skewed',
+	      'api':		'delay:POSIX',
+	      'workStealing':	1,
+	      'delayJitter':	0.002,
+	      'expect':		'share: [0-9]+ transfers, [1-9][0-9]* stolen'}],
+
+	    [{'debug':		'POSIX work stealing per node',
+	      'workStealing':	1,
+	      'workStealingPerNode':	1,
+	      'transferSize':	MEBIBYTE,
+	      'segmentCount':	3}],
+
+            # POSIX, virtual ranks
+	    [{'debug':		'POSIX virtual ranks',
+	      'virtualRanks':	4,
+	      'checkRead':	0,
+	      'storeFileOffset':1}],
+
+	    [{'debug':		'POSIX virtual ranks filePerProc',
+	      'virtualRanks':	3,
+	      'filePerProc':	1,
+	      'checkRead':	0,
+	      'segmentCount':	3}],
+
+            # POSIX, topology reorder
+	    [{'debug':		'POSIX reorderTasksTopology',
+	      'reorderTasks':	0,
+	      'reorderTasksTopology':	1}],
+	    [{'debug':		'POSIX reorderTasksTopology filePerProc',
+	      'filePerProc':	1,
+	      'reorderTasks':	0,
+	      'reorderTasksTopology':	1}],
+
+            # POSIX, N:M files
+	    [{'debug':		'POSIX tasksPerFile',
+	      'tasksPerFile':	2,
+	      'checkRead':	0,
+	      'storeFileOffset':1}],
+
+            # POSIX, subarray layout
+	    [{'debug':		'POSIX subarray layout',
+	      'globalDims':	'16x8x32',
+	      'checkRead':	0,
+	      'storeFileOffset':1,
+	      'segmentCount':	2}],
+
+            # POSIX, N-to-M restart read
+	    [{'debug':		'POSIX restart read',
+	      'writerTasks':	2,
+	      'restartBlockSize':	MEBIBYTE,
+	      'transferSize':	MEBIBYTE,
+	      'checkRead':	0}]
 	]
 
 	MPIIO_TESTS = [
@@ -495,6 +635,13 @@ class Test:
 	      'randomOffset':	1,
 	      'checkRead':	0,
 	      'repetitions':	3}],
+	    [{'debug':		'MPIIO repetitions random collective',
+	      'api':		'MPIIO',
+	      'randomOffset':	1,
+	      'collective':	1,
+	      'randomBatch':	4,
+	      'checkRead':	0,
+	      'repetitions':	3}],
 
             # MPIIO, multiFile
 	    [{'debug':		'MPIIO multiFile',
@@ -667,6 +814,13 @@ class Test:
 	      'hintsFileName':	'/g/g0/loewe/IOR/test/hintsFile',
 	      'showHints':	1}],
 
+            # MPIIO, hint tuning
+	    [{'debug':		'MPIIO hint tuning',
+	      'api':		'MPIIO',
+	      'hintSearchFile':	'./hintSearchFile',
+	      'checkWrite':	0,
+	      'checkRead':	0}],
+
             # MPIIO, setTimeStampSignature
 	    [{'debug':		'MPIIO setTimeStampSignature',
 	      'api':		'MPIIO',
@@ -858,6 +1012,16 @@ class Test:
 	      'collective':	1,
 	      'segmentCount':	3}],
 
+            # MPIIO, strided datatype
+	    [{'debug':		'MPIIO collective useStridedDatatype',
+	      'api':		'MPIIO',
+	      'useStridedDatatype':	1,
+	      'useFileView':	1,
+	      'collective':	1,
+	      'checkRead':	0,
+	      'storeFileOffset':1,
+	      'segmentCount':	8}],
+
             # MPIIO, independent, filePerProc
 	    [{'debug':		'MPIIO independent filePerProc',
 	      'api':		'MPIIO',
@@ -1056,7 +1220,42 @@ class Test:
 	      'numTasks':	2,
 	      'useFileView':	1,
 	      'collective':	1,
-	      'segmentCount':	3}]
+	      'segmentCount':	3}],
+
+            # MPIIO, N:M files
+	    [{'debug':		'MPIIO tasksPerFile collective',
+	      'api':		'MPIIO',
+	      'tasksPerFile':	2,
+	      'collective':	1,
+	      'checkRead':	0}],
+
+            # MPIIO, shared file pointer
+	    [{'debug':		'MPIIO shared file pointer ordered',
+	      'api':		'MPIIO',
+	      'useSharedFilePointer':	1,
+	      'collective':	1,
+	      'storeFileOffset':1}],
+	    [{'debug':		'MPIIO shared file pointer unordered',
+	      'api':		'MPIIO',
+	      'useSharedFilePointer':	1,
+	      'storeFileOffset':1}],
+
+            # MPIIO, nonblocking window
+	    [{'debug':		'MPIIO nonblocking window',
+	      'api':		'MPIIO',
+	      'nonblockingWindow':	4}],
+	    [{'debug':		'MPIIO nonblocking window collective',
+	      'api':		'MPIIO',
+	      'nonblockingWindow':	4,
+	      'collective':	1}],
+
+            # MPIIO, subarray layout
+	    [{'debug':		'MPIIO subarray file view',
+	      'api':		'MPIIO',
+	      'globalDims':	'16x8x32',
+	      'useFileView':	1,
+	      'collective':	1,
+	      'checkRead':	0}]
 	]
 
 	HDF5_TESTS = [
@@ -1373,15 +1572,33 @@ class Test:
 	      'segmentCount':	3}]
 	]
 
+	MEM_TESTS = [
+            # MEM, in-memory backend
+	    [{'debug':		'MEM',
+	      'api':		'MEM',
+	      'checkWrite':	1,
+	      'checkRead':	1}],
+	    [{'debug':		'MEM filePerProc',
+	      'api':		'MEM',
+	      'filePerProc':	1}],
+	    [{'debug':		'MEM no copy',
+	      'api':		'MEM',
+	      'memCopy':	0,
+	      'checkWrite':	0,
+	      'checkRead':	0}]
+	]
+
 	PassTests = []
 	if OS == "AIX":
 	    PassTests = PassTests + POSIX_TESTS
 	    PassTests = PassTests + MPIIO_TESTS
+	    PassTests = PassTests + MEM_TESTS
 	    PassTests = PassTests + HDF5_TESTS
 	    PassTests = PassTests + NCMPI_TESTS
 	elif OS == "Linux":
 	    PassTests = PassTests + POSIX_TESTS
 	    PassTests = PassTests + MPIIO_TESTS
+	    PassTests = PassTests + MEM_TESTS
 	    #PassTests = PassTests + HDF5_TESTS
 	    #PassTests = PassTests + NCMPI_TESTS
 	else:
@@ -1427,6 +1644,7 @@ class Test:
 			" -ppdebug " + executable + " -f " + scriptFile
 	else:
 	    command = "unable to run " + executable + " -f " + scriptFile
+	output = []
 	if debug == TRUE:
 	    Flush2File(command)
 	else:
@@ -1436,8 +1654,9 @@ class Test:
 		line = childOut.readline()
 		if line == '': break
 		Flush2File(line[:-1])
+		output.append(line[:-1])
 	    childOut.close()
-	return
+	return output
 
 
 ##########################
@@ -1464,6 +1683,25 @@ def Flush2File(string):
     resultsFile.flush()
 
 
+##########################################
+# check tests printed what they expected #
+##########################################
+def CheckExpected(output, expected):
+    for name in expected.keys():
+	found = FALSE
+	inTest = FALSE
+	for line in output:
+	    if line == "*** " + name + " ***":
+		inTest = TRUE
+	    elif line == "*** DEBUG MODE ***":
+		inTest = FALSE
+	    elif inTest == TRUE and re.search(expected[name], line):
+		found = TRUE
+	if found == FALSE:
+	    Flush2File("*** " + name + " FAILED: no output matching '" + \
+		       expected[name] + "' ***")
+
+
 ##################################
 # replace blanks with underscore #
 ##################################
@@ -1552,6 +1790,7 @@ for proc in proccnt:
                     os.system("rm -f " + scriptFile)
                     script = open(scriptFile, "a")
                     script.write("IOR START" + "\n")
+                    expected = {}
 
                 # start with a default test, then modify
                 testValues = test.DefaultTest()
@@ -1564,6 +1803,10 @@ for proc in proccnt:
 	        testValues['debug'] = UnderScore("Test No. " + \
 				      str(testNumber) + ":  " + \
 				      testValues['debug'])
+	        # output the test must print, checked when run on several tasks
+                expect = testValues.pop('expect', '')
+                if (expect != '' and proc > 1):
+                    expected[testValues['debug']] = expect
 	        # write test information to script file
                 for entry in testValues.keys():
 		    if (str(testValues[entry]) != ''):
@@ -1595,7 +1838,9 @@ for proc in proccnt:
                     # run
 		    os.system ("rm -rf " + testDir)
 		    os.system("mkdir " + testDir)
-                    test.RunScript(nodes, proc)
+                    output = test.RunScript(nodes, proc)
+                    if debug == FALSE:
+                        CheckExpected(output, expected)
                     os.system ("rm -rf " + testDir)
             if 0 == 0: os.system("rm -f " + scriptFile) # run scripts
 